@@ -37,20 +37,14 @@ root_data_plot_folder = f"{root_data_folder}/plot"
 root_data_table_folder = f"{root_data_folder}/table"
 
 
-def compile_executable(
-    define: str,
-):
-    """Compile the program with the given define to specify the policy.
-
-    Args:
-        define (str): The preprocessor directive to specify the policy.
+def compile_executable():
+    """Compile the program. The policy is chosen when the program runs.
     """
     output = subprocess.run(
         [
             "make",
             "-B",
             "-C", f"{root_ex_folder}",
-            "DEFINES=" f"\"-D{define}\"",
         ],
         capture_output=True,
     )
@@ -61,6 +55,7 @@ def compile_executable(
 
 
 def run_programs(
+    policy: str,
     iterations: int,
     thread_nums: List[int],
     configurations: List[Dict[str, int]],
@@ -77,6 +72,7 @@ def run_programs(
     }.
 
     Args:
+        policy (str): The rwlock implementation to run the program with (e.g. "phase_fair").
         iterations (int): The number of times to run the program with the same configuration.
         thread_nums (list[int]): The number of threads to run the program with.
         configurations (list[dict[str, int]]): The configurations to run the program with.
@@ -120,6 +116,7 @@ def run_programs(
                         "-s", f"{config['search_percentage']}",
                         "-i", f"{config['insert_percentage']}",
                         "-d", f"{config['delete_percentage']}",
+                        "-l", f"{policy}",
                     ],
                     capture_output=True,
                 )
@@ -312,10 +309,14 @@ parser.add_argument(
 if __name__ == '__main__':
     args = parser.parse_args()
 
-    defines_list = [
-        "DEFAULT",
-        "READER_PRIORITY_POLICY",
-        "WRITER_PRIORITY_POLICY"
+    policies_list = [
+        "default",
+        "reader_priority",
+        "writer_priority",
+        "phase_fair",
+        "read_mostly",
+        "futex_reader_priority",
+        "futex_writer_priority"
     ]
 
     iterations = 10
@@ -348,9 +349,9 @@ if __name__ == '__main__':
     ]
 
     if (args.execute == 1):
-        for define in defines_list:
-            compile_executable(define)
+        compile_executable()
 
+        for policy in policies_list:
             # Get time stamp
             named_tuple = time.localtime()
             date_string = time.strftime("%Y-%m-%d", named_tuple)
@@ -359,11 +360,12 @@ if __name__ == '__main__':
             save_exec_folder = f"{root_data_exec_folder}/{date_string}"
             os.makedirs(save_exec_folder, exist_ok=True)
 
-            print(f"[INFO] Running programs with policy: {define}")
+            print(f"[INFO] Running programs with policy: {policy}")
 
-            exec_file_path = f"{save_exec_folder}/{time_string}-{define.lower()}.csv"
+            exec_file_path = f"{save_exec_folder}/{time_string}-{policy}.csv"
 
             run_programs(
+                policy,
                 iterations,
                 thread_nums,
                 configurations,
@@ -0,0 +1,105 @@
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+/* Every power of two is split in 2^HISTOGRAM_SUB_BUCKET_BITS sub-buckets */
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+
+/*
+ * Number of buckets. The values smaller than HISTOGRAM_SUB_BUCKETS have a
+ * bucket each, every larger power of two [2^m, 2^(m+1)) is split in
+ * HISTOGRAM_SUB_BUCKETS buckets of the same width.
+ */
+#define HISTOGRAM_BUCKETS                                                      \
+    ((64 - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+/*
+ * Log-bucketed histogram of non-negative values, typically durations in
+ * nanoseconds, in the style of HdrHistogram: the width of a bucket grows with
+ * its values, so the relative error of the percentiles is at most
+ * 1 / HISTOGRAM_SUB_BUCKETS whatever the range of the values. Recording a
+ * value does not allocate memory or take locks, so histograms that are
+ * updated by several threads should either be protected by the caller or kept
+ * per thread and merged at the end.
+ */
+struct histogram_s {
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+    unsigned long long buckets[HISTOGRAM_BUCKETS];
+};
+
+/*
+ * Get a timestamp in nanoseconds from a monotonic clock.
+ *
+ * Returns:
+ * - the timestamp.
+ */
+unsigned long long histogram_time_ns(void);
+
+/*
+ * Reset the histogram to hold no values.
+ *
+ * Parameters:
+ * - histogram: the histogram to be reset.
+ */
+void histogram_init(struct histogram_s *histogram);
+
+/*
+ * Record a value in the histogram.
+ *
+ * Parameters:
+ * - histogram: the histogram.
+ * - value: the value to be recorded.
+ */
+void histogram_record(struct histogram_s *histogram, unsigned long long value);
+
+/*
+ * Add the values of a histogram to another one.
+ *
+ * Parameters:
+ * - destination: the histogram that receives the values.
+ * - source: the histogram whose values are added.
+ */
+void histogram_merge(
+    struct histogram_s *destination, const struct histogram_s *source
+);
+
+/*
+ * Estimate a percentile of the recorded values. The estimate is the upper
+ * bound of the bucket that holds the percentile, capped by the maximum value.
+ *
+ * Parameters:
+ * - histogram: the histogram.
+ * - percentile: the percentile in [0, 100].
+ *
+ * Returns:
+ * - the estimate of the percentile, 0 if the histogram is empty.
+ */
+unsigned long long histogram_percentile(
+    const struct histogram_s *histogram, double percentile
+);
+
+/*
+ * Print the number of values, their mean, the p50, p99 and p99.9 percentiles
+ * and the maximum value on a single line.
+ *
+ * Parameters:
+ * - histogram: the histogram.
+ * - name: the name printed before the summary.
+ */
+void histogram_print_summary(
+    const struct histogram_s *histogram, const char *name
+);
+
+/*
+ * Print the summary and the number of values of every non-empty power of two
+ * of the histogram.
+ *
+ * Parameters:
+ * - histogram: the histogram.
+ * - name: the name printed before the summary.
+ */
+void histogram_print(const struct histogram_s *histogram, const char *name);
+
+#endif
@@ -1,6 +1,119 @@
 #ifndef _LINIKEDLIST_H_
 #define _LINIKEDLIST_H_
 
+#include "rwlock.h"
+#include "set.h"
+
+/*
+ * Handle of a sorted linked list. Any number of lists can exist at the same
+ * time, every one with its own rwlock if needed. The operations on a list are
+ * not thread safe, the caller holds the rwlock of the list, or synchronizes
+ * the list in some other way.
+ */
+typedef struct List *list_t;
+
+/*
+ * Allocate and initialize an empty list, and the node pool if built with
+ * NODE_POOL.
+ *
+ * Parameters:
+ * - list: set to the new list.
+ * - lock_name: the rwlock implementation of the list, see rwlock_init(), or
+ * NULL if the list has no rwlock.
+ *
+ * Returns:
+ * - 0 if the list was initialized successfully.
+ * - 1 if an error occurred.
+ */
+int list_init(list_t *list, const char *lock_name);
+
+/*
+ * Enable or disable the fingers of a list. With fingers, every thread
+ * remembers the last node its previous search went past, and a search for a
+ * larger value starts from there instead of from the head, unless a node was
+ * removed from the list since. Operations on close values then take a few
+ * steps instead of a walk from the head.
+ *
+ * Parameters:
+ * - list: the list.
+ * - enabled: 1 to enable the fingers, 0 to disable them.
+ */
+void list_use_fingers(list_t list, int enabled);
+
+/*
+ * Get the rwlock of a list.
+ *
+ * Parameters:
+ * - list: the list, initialized with a rwlock.
+ *
+ * Returns:
+ * - the rwlock of the list.
+ */
+rwlock_t *list_rwlock(list_t list);
+
+/*
+ * Free every node of a list, leaving it empty.
+ *
+ * Parameters:
+ * - list: the list.
+ */
+void list_clear(list_t list);
+
+/*
+ * Free every node of a list, its rwlock and the list itself.
+ *
+ * Parameters:
+ * - list: the list, set to NULL.
+ *
+ * Returns:
+ * - 0 if the list was destroyed successfully.
+ * - non-zero value if an error occurred.
+ */
+int list_destroy(list_t *list);
+
+/*
+ * Same as insert(), print(), member(), delete(), insert_upgradeable(),
+ * delete_upgradeable(), insert_many(), member_many(), delete_many(),
+ * bulk_load(), range_count() and iterate(), on the given list.
+ */
+int list_insert(list_t list, int value);
+void list_print(list_t list);
+int list_member(list_t list, int value);
+int list_delete(list_t list, int value);
+int list_insert_upgradeable(list_t list, int value, rwlock_t *rwlock);
+int list_delete_upgradeable(list_t list, int value, rwlock_t *rwlock);
+int list_insert_many(list_t list, int *values, int count);
+int list_member_many(list_t list, int *values, int count, int *results);
+int list_delete_many(list_t list, int *values, int count);
+void list_bulk_load(list_t list, const int *values, int count);
+int list_range_count(list_t list, int lo, int hi);
+int list_iterate(list_t list, int lo, int hi, struct set_iterator_s *iterator);
+
+/*
+ * Insert and delete values in a single pass over a list. Requests for the same
+ * value are applied in the order of the arrays.
+ *
+ * Parameters:
+ * - list: the list.
+ * - values: the values to be inserted or deleted, sorted in ascending order.
+ * - inserts: 1 for every value to be inserted, 0 for every value to be
+ * deleted.
+ * - count: the number of values.
+ * - results: set to the result that insert() or delete() would have returned
+ * for every value.
+ *
+ * Returns:
+ * - the number of values that were inserted or deleted.
+ */
+int list_update_many(
+    list_t list, const int *values, const int *inserts, int count,
+    int *results
+);
+
+/*
+ * The following functions work on a single default list, without rwlock.
+ */
+
 /*
  * Insert value in a correct numerical location into list.
  *
@@ -42,6 +155,114 @@ int member(int value);
  */
 int delete(int value);
 
+/*
+ * Insert value like insert(), searching in shared mode. The rwlock is upgraded
+ * only if the value is not in list, to link the new node.
+ *
+ * Parameters:
+ * - value: value to be inserted.
+ * - rwlock: the rwlock, locked by rwlock_rdlock_upgradeable().
+ *
+ * Returns:
+ * - 0 if value is in list.
+ * - 1 if value is not in list.
+ * - -1 if the rwlock could not be upgraded.
+ */
+int insert_upgradeable(int value, rwlock_t *rwlock);
+
+/*
+ * Delete value like delete(), searching in shared mode. The rwlock is
+ * upgraded only if the value is in list, to unlink its node.
+ *
+ * Parameters:
+ * - value: value to be deleted.
+ * - rwlock: the rwlock, locked by rwlock_rdlock_upgradeable().
+ *
+ * Returns:
+ * - 0 if value is not in list.
+ * - 1 if value is in list.
+ * - -1 if the rwlock could not be upgraded.
+ */
+int delete_upgradeable(int value, rwlock_t *rwlock);
+
+/*
+ * Insert a batch of values in a single pass over the list. The batch is sorted
+ * first, unless it is already sorted.
+ *
+ * Parameters:
+ * - values: the values to be inserted, sorted in place.
+ * - count: the number of values.
+ *
+ * Returns:
+ * - the number of values that were not in list.
+ */
+int insert_many(int *values, int count);
+
+/*
+ * Check a batch of values in a single pass over the list. The batch is sorted
+ * first, unless it is already sorted.
+ *
+ * Parameters:
+ * - values: the values to be checked, sorted in place.
+ * - count: the number of values.
+ * - results: if not NULL, set to 1 for every value (in sorted order) that is
+ * in list and to 0 otherwise.
+ *
+ * Returns:
+ * - the number of values that are in list.
+ */
+int member_many(int *values, int count, int *results);
+
+/*
+ * Delete a batch of values in a single pass over the list. The batch is sorted
+ * first, unless it is already sorted.
+ *
+ * Parameters:
+ * - values: the values to be deleted, sorted in place.
+ * - count: the number of values.
+ *
+ * Returns:
+ * - the number of values that were in list.
+ */
+int delete_many(int *values, int count);
+
+/*
+ * Fill the empty list with strictly increasing values, linking the nodes in
+ * a single pass without searching the list.
+ *
+ * Parameters:
+ * - values: the values to be inserted, strictly increasing.
+ * - count: the number of values.
+ */
+void bulk_load(const int *values, int count);
+
+/*
+ * Count the values of the list in [lo, hi).
+ *
+ * Parameters:
+ * - lo: the smallest value of the range.
+ * - hi: the value after the largest value of the range.
+ *
+ * Returns:
+ * - the number of values of the list in [lo, hi).
+ */
+int range_count(int lo, int hi);
+
+/*
+ * Copy the values of the list in [lo, hi) and initialize an iterator over
+ * the copy, which stays valid while the list changes.
+ *
+ * Parameters:
+ * - lo: the smallest value of the range.
+ * - hi: the value after the largest value of the range.
+ * - iterator: the iterator, to be destroyed with set_iterator_destroy().
+ *
+ * Returns:
+ * - 0 if the iterator was initialized successfully.
+ * - 1 if an error occurred.
+ */
+int iterate(int lo, int hi, struct set_iterator_s *iterator);
+
 /*
  * Free the whole list.
  */
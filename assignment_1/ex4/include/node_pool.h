@@ -0,0 +1,85 @@
+#ifndef _NODE_POOL_H_
+#define _NODE_POOL_H_
+
+#include <stddef.h>
+
+/*
+ * Fixed-size node allocator for the list nodes.
+ *
+ * Every thread owns a magazine of free nodes, so that allocating or freeing a
+ * node inside a critical section is a pointer pop/push. Magazines are refilled
+ * from and flushed to a global depot in batches of NODE_POOL_BATCH nodes,
+ * and the depot carves new batches from slabs that are only released in bulk
+ * by node_pool_destroy().
+ *
+ * The depot traffic can be moved outside of the critical sections by calling
+ * node_pool_reserve() before taking the lock for an insertion and
+ * node_pool_trim() after releasing the lock of a deletion.
+ */
+
+/* Number of nodes moved between a magazine and the depot at once */
+#define NODE_POOL_BATCH 64
+
+/* Number of nodes carved from a single slab */
+#define NODE_POOL_SLAB_NODES 4096
+
+/*
+ * Initialize the pool. Calling it again while the pool is initialized has no
+ * effect.
+ *
+ * Parameters:
+ * - size: the size of a node in bytes.
+ *
+ * Returns:
+ * - 0 if the pool was initialized successfully.
+ * - 1 if an error occurred.
+ */
+int node_pool_init(size_t size);
+
+/*
+ * Allocate a node from the magazine of the calling thread.
+ *
+ * Returns:
+ * - a pointer to the node.
+ * - NULL if an error occurred.
+ */
+void *node_pool_alloc(void);
+
+/*
+ * Return a node to the magazine of the calling thread.
+ *
+ * Parameters:
+ * - node: the node, previously returned by node_pool_alloc().
+ */
+void node_pool_free(void *node);
+
+/*
+ * Make sure that the magazine of the calling thread holds at least one node,
+ * so that the next node_pool_alloc() does not touch the depot.
+ */
+void node_pool_reserve(void);
+
+/*
+ * Flush the surplus nodes of the magazine of the calling thread to the depot,
+ * so that the next node_pool_free() calls do not touch the depot.
+ */
+void node_pool_trim(void);
+
+/*
+ * Return the magazine of the calling thread to the depot and merge its
+ * counters into the global ones. Should be called before a thread exits.
+ */
+void node_pool_thread_exit(void);
+
+/*
+ * Release every slab of the pool at once. All the nodes that were allocated
+ * by the pool become invalid.
+ */
+void node_pool_destroy(void);
+
+/*
+ * Print the counters of the pool.
+ */
+void node_pool_print_stats(void);
+
+#endif
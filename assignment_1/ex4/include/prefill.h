@@ -0,0 +1,30 @@
+#ifndef _PREFILL_H_
+#define _PREFILL_H_
+
+/* Smallest number of keys that is worth sorting in a thread of its own */
+#define PREFILL_MIN_CHUNK 16384
+
+/*
+ * Generate the keys that are inserted before the threads start, sorted and
+ * without duplicates. The keys are the ones that inserting my_rand() % max_key
+ * one at a time would leave in the set: the first count distinct keys of the
+ * random sequence of the seed, giving up after 2 * count draws.
+ *
+ * Parameters:
+ * - count: the number of distinct keys wanted.
+ * - max_key: keys are less than max_key.
+ * - seed: the seed of the random sequence.
+ * - threads: the number of threads that sort the keys.
+ * - keys_p: set to the keys, to be freed by the caller.
+ * - count_p: set to the number of keys, at most count.
+ *
+ * Returns:
+ * - 0 if the keys were generated successfully.
+ * - 1 if an error occurred.
+ */
+int prefill_generate(
+    int count, int max_key, unsigned seed, int threads, int **keys_p,
+    int *count_p
+);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _QSBR_H_
+#define _QSBR_H_
+
+/*
+ * Quiescent-state-based reclamation.
+ *
+ * Readers of a structure that is updated in place take no lock and write no
+ * shared memory while they read. Instead, every thread that reads announces,
+ * between two operations, that it holds no reference into the structure (a
+ * quiescent state). Writers unlink a node and retire it, and a retired node
+ * is freed only after every online thread has gone through a quiescent state,
+ * i.e. after a grace period.
+ *
+ * A global epoch is incremented by every retirement. A quiescent state copies
+ * the epoch into the cache line padded record of the thread, so a node
+ * retired at epoch E is safe to free once every online thread has recorded an
+ * epoch not smaller than E.
+ */
+
+/* Number of retired nodes between two attempts to free them */
+#define QSBR_BATCH 64
+
+/*
+ * Register the calling thread as a reader. Should be called before the
+ * thread reads the structure for the first time.
+ */
+void qsbr_thread_online(void);
+
+/*
+ * Announce that the calling thread holds no reference into the structure.
+ * Should be called between the operations of an online thread.
+ */
+void qsbr_quiescent(void);
+
+/*
+ * Unregister the calling thread. Should be called before a thread exits, it
+ * no longer delays the reclamation.
+ */
+void qsbr_thread_offline(void);
+
+/*
+ * Free a node once every online thread has gone through a quiescent state.
+ * The node should already be unreachable for new readers.
+ *
+ * Parameters:
+ * - ptr: the node, allocated with malloc().
+ */
+void qsbr_retire(void *ptr);
+
+/*
+ * Free every retired node whose grace period has elapsed. When no thread is
+ * online, every retired node is freed.
+ */
+void qsbr_reclaim(void);
+
+#endif
@@ -1,16 +1,43 @@
+#ifndef _RWLOCK_H_
+#define _RWLOCK_H_
+
 typedef struct RWLock *rwlock_t;
 
+/*
+ * Get the number of the available rwlock implementations.
+ *
+ * Returns:
+ * - the number of the implementations.
+ */
+int rwlock_implementation_count(void);
+
+/*
+ * Get the name of an available rwlock implementation, as accepted by
+ * rwlock_init().
+ *
+ * Parameters:
+ * - index: the index of the implementation, smaller than
+ * rwlock_implementation_count().
+ *
+ * Returns:
+ * - the name of the implementation.
+ */
+const char *rwlock_implementation_name(int index);
+
 /*
  * Initializes the rwlock.
  *
  * Parameters:
  * - rwlock: the rwlock to be initialized.
+ * - name: the name of the implementation, one of "default",
+ * "reader_priority", "writer_priority", "phase_fair", "read_mostly",
+ * "futex_reader_priority" and "futex_writer_priority".
  *
  * Returns:
  * - 0 if the rwlock was initialized successfully.
- * - non-zero value if an error occurred.
+ * - non-zero value if the name is unknown or an error occurred.
  */
-int rwlock_init(rwlock_t *rwlock);
+int rwlock_init(rwlock_t *rwlock, const char *name);
 
 /*
  * Locks the rwlock for reading.
@@ -36,6 +63,49 @@ int rwlock_rdlock(rwlock_t *rwlock);
  */
 int rwlock_wrlock(rwlock_t *rwlock);
 
+/*
+ * Locks the rwlock for reading, with the right to upgrade the lock to writing
+ * later. At most one thread holds the rwlock in upgradeable mode, alongside
+ * any number of readers, so the data cannot change until the thread upgrades
+ * or unlocks. Implementations without native support lock for writing.
+ *
+ * Parameters:
+ * - rwlock: the rwlock to be locked.
+ *
+ * Returns:
+ * - 0 if the rwlock was locked successfully.
+ * - non-zero value if an error occurred.
+ */
+int rwlock_rdlock_upgradeable(rwlock_t *rwlock);
+
+/*
+ * Upgrades the rwlock from upgradeable mode to writing, waiting for the
+ * readers to drain. The data read in upgradeable mode is still valid after
+ * the upgrade.
+ *
+ * Parameters:
+ * - rwlock: the rwlock, locked by rwlock_rdlock_upgradeable().
+ *
+ * Returns:
+ * - 0 if the rwlock was upgraded successfully.
+ * - non-zero value if an error occurred.
+ */
+int rwlock_upgrade(rwlock_t *rwlock);
+
+/*
+ * Downgrades the rwlock from writing to reading, without letting another
+ * writer in between. Implementations without native support keep the rwlock
+ * locked for writing until it is unlocked.
+ *
+ * Parameters:
+ * - rwlock: the rwlock, locked for writing.
+ *
+ * Returns:
+ * - 0 if the rwlock was downgraded successfully.
+ * - non-zero value if an error occurred.
+ */
+int rwlock_downgrade(rwlock_t *rwlock);
+
 /*
  * Unlocks the rwlock.
  *
@@ -58,4 +128,6 @@ int rwlock_unlock(rwlock_t *rwlock);
  * - 0 if the rwlock was destroyed successfully.
  * - non-zero value if an error occurred.
  */
-int rwlock_destroy(rwlock_t *rwlock);
\ No newline at end of file
+int rwlock_destroy(rwlock_t *rwlock);
+
+#endif
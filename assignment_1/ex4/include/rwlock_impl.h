@@ -0,0 +1,71 @@
+#ifndef _RWLOCK_IMPL_H_
+#define _RWLOCK_IMPL_H_
+
+/*
+ * Interface between the rwlock front end and its implementations.
+ *
+ * Every implementation keeps its own state behind an opaque pointer and
+ * exports a table of operations. The front end in rwlock.c registers the
+ * tables under the names accepted by rwlock_init(), together with the policy
+ * that is passed to the init operation.
+ */
+
+/* Policies understood by the implementations that support more than one */
+#define RWLOCK_READER_PRIORITY 0
+#define RWLOCK_WRITER_PRIORITY 1
+#define RWLOCK_PHASE_FAIR 2
+
+struct rwlock_ops_s {
+    /*
+     * Allocate and initialize the state of a rwlock.
+     *
+     * Parameters:
+     * - lock: set to the state of the rwlock.
+     * - policy: one of the RWLOCK_*_PRIORITY or RWLOCK_PHASE_FAIR policies.
+     *
+     * Returns:
+     * - 0 if the rwlock was initialized successfully.
+     * - non-zero value if an error occurred.
+     */
+    int (*init)(void **lock, int policy);
+
+    /* Same as rwlock_rdlock(), rwlock_wrlock() and rwlock_unlock() */
+    int (*rdlock)(void *lock);
+    int (*wrlock)(void *lock);
+    int (*unlock)(void *lock);
+
+    /*
+     * Same as rwlock_rdlock_upgradeable(), rwlock_upgrade() and
+     * rwlock_downgrade(). NULL if the implementation has no upgradeable mode,
+     * the front end then locks for writing instead.
+     */
+    int (*rdlock_upgradeable)(void *lock);
+    int (*upgrade)(void *lock);
+    int (*downgrade)(void *lock);
+
+    /*
+     * Destroy and free the state of a rwlock.
+     *
+     * Parameters:
+     * - lock: the state of the rwlock.
+     *
+     * Returns:
+     * - 0 if the rwlock was destroyed successfully.
+     * - non-zero value if an error occurred.
+     */
+    int (*destroy)(void *lock);
+};
+
+/* pthread_rwlock_t, the policy is ignored */
+extern const struct rwlock_ops_s default_rwlock_ops;
+
+/* Mutex and condition variables, every policy is supported */
+extern const struct rwlock_ops_s cond_rwlock_ops;
+
+/* Per-thread reader indicators, always gives priority to writers */
+extern const struct rwlock_ops_s read_mostly_rwlock_ops;
+
+/* Single futex state word, reader or writer priority */
+extern const struct rwlock_ops_s futex_rwlock_ops;
+
+#endif
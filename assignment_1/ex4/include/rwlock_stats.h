@@ -0,0 +1,71 @@
+#ifndef _RWLOCK_STATS_H_
+#define _RWLOCK_STATS_H_
+
+/* Number of threads whose acquisitions are recorded, by thread slot */
+#define RWLOCK_STATS_THREADS 64
+
+/* Modes of acquisition */
+#define RWLOCK_STATS_READ 0
+#define RWLOCK_STATS_WRITE 1
+
+/*
+ * Contention statistics of a rwlock instance.
+ *
+ * Every thread records its acquisitions in its own buffer, indexed by its
+ * thread slot and padded to whole cache lines, so recording takes no locks
+ * and shares no cache lines with other threads. The slots of the threads
+ * that exited are reused, so only the threads alive at the same time count
+ * against RWLOCK_STATS_THREADS. The events of threads whose slot is not
+ * smaller than RWLOCK_STATS_THREADS are not recorded but counted, and a
+ * warning is printed. The buffers are merged and printed when the
+ * statistics are destroyed.
+ */
+struct rwlock_stats_s;
+
+/*
+ * Allocate and reset the statistics of a rwlock.
+ *
+ * Parameters:
+ * - stats: the statistics to be initialized.
+ *
+ * Returns:
+ * - 0 if the statistics were initialized successfully.
+ * - 1 if an error occurred.
+ */
+int rwlock_stats_init(struct rwlock_stats_s **stats);
+
+/*
+ * Record that the calling thread acquired the rwlock. The acquisition also
+ * starts the hold time of the thread.
+ *
+ * Parameters:
+ * - stats: the statistics of the rwlock.
+ * - mode: RWLOCK_STATS_READ or RWLOCK_STATS_WRITE.
+ * - wait_start: the timestamp (histogram_time_ns()) when the thread started
+ * waiting for the rwlock.
+ * - contended: 1 if the thread could not acquire the rwlock at once.
+ * - wakeups: the number of times the thread was woken while waiting.
+ */
+void rwlock_stats_acquired(
+    struct rwlock_stats_s *stats, int mode, unsigned long long wait_start,
+    int contended, int wakeups
+);
+
+/*
+ * Record that the calling thread is about to release the rwlock, which ends
+ * its hold time.
+ *
+ * Parameters:
+ * - stats: the statistics of the rwlock.
+ */
+void rwlock_stats_released(struct rwlock_stats_s *stats);
+
+/*
+ * Merge the per-thread buffers, print the statistics and free them.
+ *
+ * Parameters:
+ * - stats: the statistics to be destroyed.
+ */
+void rwlock_stats_destroy(struct rwlock_stats_s **stats);
+
+#endif
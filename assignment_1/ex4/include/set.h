@@ -0,0 +1,234 @@
+#ifndef _SET_H_
+#define _SET_H_
+
+#include "rwlock.h"
+
+/* Parameters of the set implementations that take them */
+struct set_params_s {
+    /* The rwlock implementation of a set that takes its own rwlocks */
+    const char *lock_name;
+    /* The number of shards of a sharded set */
+    int shards;
+    /* Keys are less than max_key */
+    int max_key;
+    /* Start searches from the last node of the thread, if the set can */
+    int fingers;
+};
+
+/*
+ * An iterator over a snapshot of the keys of a range, see the iterate
+ * operation of struct set_ops_s. The snapshot is taken once, when the
+ * iterator is created, so iterating takes no lock and never sees the changes
+ * made after it.
+ */
+struct set_iterator_s {
+    /* The keys of the snapshot, in increasing order */
+    const int *keys;
+    int count;
+    /* The index of the next key */
+    int next;
+    /* The keys copied by the snapshot, NULL if keys point inside the set */
+    int *copy;
+    int capacity;
+};
+
+/*
+ * A set implementation that can be selected at runtime. The operations have
+ * the same semantics as the ones of linkedlist.h and work on the single set
+ * of the implementation. Unless the implementation is synchronized, they are
+ * not thread safe and the caller holds the rwlock.
+ */
+struct set_ops_s {
+    const char *name;
+    /* The operations synchronize themselves, the rwlock is not taken */
+    int synchronized;
+    /*
+     * The set synchronizes itself with rwlocks of its own, of the
+     * implementation given by the parameters. Implies synchronized.
+     */
+    int own_rwlocks;
+    /*
+     * Called before the set is filled, if not NULL. Returns 0 if the set was
+     * initialized successfully, non-zero value if an error occurred.
+     */
+    int (*init)(const struct set_params_s *params);
+    int (*insert)(int value);
+    void (*print)(void);
+    int (*member)(int value);
+    int (*delete)(int value);
+    /*
+     * Fill the empty set with strictly increasing values, in time linear in
+     * their number. NULL if the implementation cannot, the values are then
+     * inserted one at a time.
+     */
+    void (*bulk_load)(const int *values, int count);
+    /* Empty the set, releasing what init allocated */
+    void (*free_list)(void);
+    /*
+     * Called by every thread before its first operation, between two of its
+     * operations and after its last operation, if not NULL.
+     */
+    void (*thread_online)(void);
+    void (*quiescent)(void);
+    void (*thread_offline)(void);
+    /*
+     * Same as insert_upgradeable() and delete_upgradeable() of linkedlist.h,
+     * NULL if the implementation cannot search in shared mode.
+     */
+    int (*insert_upgradeable)(int value, rwlock_t *rwlock);
+    int (*delete_upgradeable)(int value, rwlock_t *rwlock);
+    /*
+     * Same as insert_many(), member_many() and delete_many() of
+     * linkedlist.h, NULL if the implementation has no batched operations.
+     */
+    int (*insert_many)(int *values, int count);
+    int (*member_many)(int *values, int count, int *results);
+    int (*delete_many)(int *values, int count);
+    /*
+     * Count the values in [lo, hi), as they were at a single point in time.
+     * Like the other operations, the caller holds the rwlock (for reading)
+     * unless the implementation is synchronized.
+     */
+    int (*range_count)(int lo, int hi);
+    /*
+     * Take a snapshot of the values in [lo, hi), as they were at a single
+     * point in time, and initialize an iterator over it, to be destroyed
+     * with set_iterator_destroy(). The rwlock is only needed while the
+     * snapshot is taken. The iterator of a set with quiescent states may
+     * point inside the set, so the calling thread does not announce a
+     * quiescent state until it destroys the iterator. Returns 0 if the
+     * iterator was initialized successfully, non-zero value if an error
+     * occurred.
+     */
+    int (*iterate)(int lo, int hi, struct set_iterator_s *iterator);
+};
+
+/* The sorted linked list of linkedlist.c */
+extern const struct set_ops_s list_set_ops;
+
+/* The unrolled linked list of unrolled_linkedlist.c */
+extern const struct set_ops_s unrolled_set_ops;
+
+/* The linked list of rcu_linkedlist.c, with lock-free reads */
+extern const struct set_ops_s rcu_set_ops;
+
+/*
+ * The sharded sets of sharded_set.c, which spread the keys over independent
+ * lists with a rwlock each, by hash or by key range.
+ */
+extern const struct set_ops_s sharded_hash_set_ops;
+extern const struct set_ops_s sharded_range_set_ops;
+
+/*
+ * The list of flat_combining.c, whose writers publish their requests and let
+ * a single thread apply them together.
+ */
+extern const struct set_ops_s flat_combining_set_ops;
+
+/*
+ * The sorted array of cow_array.c, with lock-free reads and writers that
+ * publish a new copy of the array.
+ */
+extern const struct set_ops_s cow_array_set_ops;
+
+/*
+ * Initialize an iterator over an empty snapshot, which set_iterator_append()
+ * then fills.
+ *
+ * Parameters:
+ * - iterator: the iterator.
+ */
+void set_iterator_init(struct set_iterator_s *iterator);
+
+/*
+ * Append a value to the snapshot of an iterator.
+ *
+ * Parameters:
+ * - iterator: the iterator, initialized with set_iterator_init().
+ * - value: the value, larger than the values already appended.
+ *
+ * Returns:
+ * - 0 if the value was appended successfully.
+ * - 1 if an error occurred.
+ */
+int set_iterator_append(struct set_iterator_s *iterator, int value);
+
+/*
+ * Get the next value of an iterator.
+ *
+ * Parameters:
+ * - iterator: the iterator.
+ * - value_p: set to the next value.
+ *
+ * Returns:
+ * - 1 if a value was returned.
+ * - 0 if every value of the snapshot has been returned.
+ */
+int set_iterator_next(struct set_iterator_s *iterator, int *value_p);
+
+/*
+ * Release the snapshot of an iterator.
+ *
+ * Parameters:
+ * - iterator: the iterator.
+ */
+void set_iterator_destroy(struct set_iterator_s *iterator);
+
+/*
+ * Get the number of the available set implementations.
+ *
+ * Returns:
+ * - the number of the implementations.
+ */
+int set_implementation_count(void);
+
+/*
+ * Get an available set implementation.
+ *
+ * Parameters:
+ * - index: the index of the implementation, smaller than
+ * set_implementation_count().
+ *
+ * Returns:
+ * - the operations of the implementation.
+ */
+const struct set_ops_s *set_implementation(int index);
+
+/*
+ * Find a set implementation by name.
+ *
+ * Parameters:
+ * - name: the name of the implementation, "list", "unrolled", "rcu",
+ * "sharded_hash", "sharded_range", "flat_combining" or "cow_array".
+ *
+ * Returns:
+ * - the operations of the implementation.
+ * - NULL if the name is unknown.
+ */
+const struct set_ops_s *set_find(const char *name);
+
+/*
+ * Compare two keys for qsort() and bsearch().
+ *
+ * Parameters:
+ * - a: the first key, an int.
+ * - b: the second key, an int.
+ *
+ * Returns:
+ * - a negative, zero or positive value if the first key is smaller than,
+ * equal to or larger than the second one.
+ */
+int set_compare_keys(const void *a, const void *b);
+
+/*
+ * Sort a batch of values, unless it is already sorted. The caller can sort
+ * the batch before taking the rwlock, the check is then the only work done
+ * in the critical section.
+ *
+ * Parameters:
+ * - values: the values to be sorted.
+ * - count: the number of values.
+ */
+void set_sort_batch(int *values, int count);
+
+#endif
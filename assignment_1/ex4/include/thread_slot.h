@@ -0,0 +1,18 @@
+#ifndef _THREAD_SLOT_H_
+#define _THREAD_SLOT_H_
+
+/*
+ * Get the slot of the calling thread.
+ *
+ * Slots are small dense integers handed out in the order in which the threads
+ * first call this function, starting from 0. A thread keeps its slot for its
+ * whole lifetime, so the slot can be used to index per-thread data. The slot
+ * is released when the thread exits and handed to a later thread, so the
+ * slots stay as few as the threads alive at the same time.
+ *
+ * Returns:
+ * - the slot of the calling thread.
+ */
+int thread_slot(void);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "workload.h"
+
+/*
+ * Binary trace of the operations of every thread.
+ *
+ * A trace file starts with a struct trace_header_s, followed by one struct
+ * trace_section_s per thread and then by the records, which are struct
+ * operation_s of workload.h (key, thread and operation, 8 bytes each). The
+ * records of a thread are contiguous and in the order the thread performs
+ * them, and the section of the thread tells where they are. Every field is
+ * in the byte order of the machine that wrote the trace.
+ */
+
+#define TRACE_MAGIC "EX4TRACE"
+#define TRACE_VERSION 1
+
+struct trace_header_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t thread_count;
+    uint64_t record_count;
+};
+
+/* The records of a thread */
+struct trace_section_s {
+    /* Index of the first record of the thread, among all the records */
+    uint64_t offset;
+    uint64_t count;
+};
+
+/* A trace file mapped in memory */
+struct trace_s {
+    void *map;
+    size_t size;
+    int thread_count;
+    /* The records of every thread, pointing inside the mapping */
+    const struct operation_s **thread_ops;
+    /* The number of records of every thread */
+    int *thread_counts;
+    long long record_count;
+};
+
+/*
+ * Write the operations of every thread to a trace file.
+ *
+ * Parameters:
+ * - path: the path of the trace file, replaced if it exists.
+ * - thread_ops: the operations of every thread.
+ * - thread_counts: the number of operations of every thread.
+ * - thread_count: the number of threads.
+ *
+ * Returns:
+ * - 0 if the trace was written successfully.
+ * - 1 if an error occurred.
+ */
+int trace_write(
+    const char *path, const struct operation_s *const *thread_ops,
+    const int *thread_counts, int thread_count
+);
+
+/*
+ * Map a trace file in memory and check it. The pages of the records are
+ * populated when the trace is opened, so replaying it does not fault.
+ *
+ * Parameters:
+ * - trace: the trace.
+ * - path: the path of the trace file.
+ *
+ * Returns:
+ * - 0 if the trace was opened successfully.
+ * - 1 if the file could not be mapped or is not a valid trace.
+ */
+int trace_open(struct trace_s *trace, const char *path);
+
+/*
+ * Unmap a trace file.
+ *
+ * Parameters:
+ * - trace: the trace.
+ */
+void trace_close(struct trace_s *trace);
+
+#endif
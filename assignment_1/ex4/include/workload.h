@@ -0,0 +1,159 @@
+#ifndef _WORKLOAD_H_
+#define _WORKLOAD_H_
+
+#include <stdint.h>
+
+/* Operations of the pre-generated operation stream */
+#define OP_MEMBER 0
+#define OP_INSERT 1
+#define OP_DELETE 2
+
+/* Key distributions */
+#define WORKLOAD_UNIFORM 0
+#define WORKLOAD_ZIPF 1
+#define WORKLOAD_HOTSPOT 2
+#define WORKLOAD_SEQUENTIAL 3
+#define WORKLOAD_LATEST 4
+
+/* Maximum number of phases of a workload */
+#define WORKLOAD_MAX_PHASES 16
+
+/* Number of recent inserts the latest distribution draws from */
+#define WORKLOAD_LATEST_WINDOW 4096
+
+/*
+ * An operation of the pre-generated operation stream, which is also the
+ * record of a trace file (see trace.h).
+ */
+struct operation_s {
+    int32_t key;
+    /* The rank of the thread that performs the operation */
+    uint16_t thread;
+    /* One of OP_MEMBER, OP_INSERT or OP_DELETE */
+    uint8_t type;
+    uint8_t reserved;
+};
+
+/* The operation mix of a phase */
+struct workload_phase_s {
+    /* The share of the operations of every thread that run in this phase */
+    double fraction;
+    double search_percent;
+    double insert_percent;
+    double delete_percent;
+};
+
+/*
+ * Description of the operation streams of the threads. The operations of
+ * every thread are split in consecutive phases, each with its own mix, and
+ * the keys of all the phases are drawn from the same distribution.
+ */
+struct workload_s {
+    /* One of the WORKLOAD_* distributions */
+    int distribution;
+    /* Skew of the zipf and latest distributions, 0 is uniform */
+    double theta;
+    /* Share of the keys that are hot and share of the operations on them */
+    double hot_fraction;
+    double hot_probability;
+    /* If set, every thread draws its keys from its own slice of the keys */
+    int partitioned;
+    /* Keys are less than max_key */
+    int max_key;
+    int phase_count;
+    struct workload_phase_s phases[WORKLOAD_MAX_PHASES];
+};
+
+/*
+ * Initialize a workload with uniform keys and a single phase.
+ *
+ * Parameters:
+ * - workload: the workload to be initialized.
+ * - max_key: keys are less than max_key.
+ * - search_percent: percentage of search operations.
+ * - insert_percent: percentage of insert operations.
+ * - delete_percent: percentage of delete operations.
+ */
+void workload_init(
+    struct workload_s *workload, int max_key, double search_percent,
+    double insert_percent, double delete_percent
+);
+
+/*
+ * Set the key distribution of a workload from its description, one of:
+ * - uniform
+ * - zipf:<theta>, e.g. zipf:0.99. The hottest keys are scattered over the
+ * key range rather than being the smallest keys.
+ * - hotspot:<hot_fraction>:<hot_probability>, e.g. hotspot:0.01:0.9 sends
+ * 90% of the operations to 1% of the keys.
+ * - sequential: every thread walks the keys in order, starting from its own
+ * offset.
+ * - latest[:<theta>]: searches and deletes draw from the most recent inserts
+ * of the thread, skewed towards the newest by a zipf distribution (default
+ * theta 0.99). Inserts draw uniform keys.
+ *
+ * Parameters:
+ * - workload: the workload.
+ * - description: the description of the distribution.
+ *
+ * Returns:
+ * - 0 if the description was parsed successfully.
+ * - 1 if an error occurred.
+ */
+int workload_parse_distribution(
+    struct workload_s *workload, const char *description
+);
+
+/*
+ * Set the phases of a workload from their description, a comma separated
+ * list of <fraction>:<search>:<insert>:<delete> phases, e.g.
+ * 0.8:0.99:0.005:0.005,0.2:0.2:0.4:0.4 for a read burst followed by a write
+ * burst. The fractions are relative to their sum.
+ *
+ * Parameters:
+ * - workload: the workload.
+ * - description: the description of the phases.
+ *
+ * Returns:
+ * - 0 if the description was parsed successfully.
+ * - 1 if an error occurred.
+ */
+int workload_parse_phases(struct workload_s *workload, const char *description);
+
+/*
+ * Get the first operation of a phase in the stream of a thread. The phase
+ * ends where the next one begins.
+ *
+ * Parameters:
+ * - workload: the workload.
+ * - phase: the phase, workload->phase_count for the end of the stream.
+ * - ops_per_thread: the number of operations of every thread.
+ *
+ * Returns:
+ * - the index of the first operation of the phase.
+ */
+int workload_phase_begin(
+    const struct workload_s *workload, int phase, int ops_per_thread
+);
+
+/*
+ * Generate the operation stream of a thread. The stream depends only on the
+ * workload and the rank of the thread, so every run executes the same one.
+ *
+ * Parameters:
+ * - workload: the workload.
+ * - rank: the rank of the thread.
+ * - thread_count: the number of threads.
+ * - ops: set to the operations of the thread.
+ * - ops_per_thread: the number of operations of every thread.
+ *
+ * Returns:
+ * - 0 if the operations were generated successfully.
+ * - 1 if an error occurred.
+ */
+int workload_generate(
+    const struct workload_s *workload, long rank, int thread_count,
+    struct operation_s *ops, int ops_per_thread
+);
+
+#endif
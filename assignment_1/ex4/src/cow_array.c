@@ -0,0 +1,394 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "qsbr.h"
+#include "set.h"
+
+/* Keys counted linearly once the binary search has narrowed down to them */
+#define LINEAR_KEYS 16
+
+/*
+ * A version of the set, never modified once it is published. Writers copy
+ * the current version, change the copy and publish it in place of the
+ * current one.
+ */
+struct cow_array_s {
+    int count;
+    /* The keys, in strictly increasing order */
+    int keys[];
+};
+
+/* The current version, NULL while the set is empty */
+static struct cow_array_s *_Atomic current = NULL;
+
+/* Serializes the writers, readers never take it */
+static pthread_mutex_t mutex_w = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Count the keys that are smaller than a value. A branchless binary search
+ * narrows the keys down to at most LINEAR_KEYS consecutive ones, which are
+ * then compared with the value four at a time.
+ *
+ * Parameters:
+ * - keys: the keys, in increasing order.
+ * - count: the number of keys.
+ * - value: the value.
+ *
+ * Returns:
+ * - the number of keys smaller than value, i.e. the index of the first key
+ * that is not smaller than value.
+ */
+static int _rank(const int *keys, int count, int value) {
+    const int *base = keys;
+    int n = count;
+
+    // Every key before base is smaller than value and every key from
+    // base + n on is not, the comparison only selects the next base
+    while(n > LINEAR_KEYS) {
+        int half = n / 2;
+
+        base = (base[half] < value) ? base + half : base;
+        n -= half;
+    }
+
+    int rank = base - keys;
+    int i = 0;
+
+#ifdef __SSE2__
+    __m128i needle = _mm_set1_epi32(value);
+
+    for(; i + 4 <= n; i += 4) {
+        __m128i smaller = _mm_cmplt_epi32(
+            _mm_loadu_si128((const __m128i *)(base + i)), needle
+        );
+        rank += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(smaller)));
+    }
+#endif
+    for(; i < n; i++) {
+        rank += base[i] < value;
+    }
+
+    return rank;
+}
+
+/*
+ * Allocate a version.
+ *
+ * Parameters:
+ * - count: the number of keys.
+ *
+ * Returns:
+ * - a pointer to the version, with count set.
+ * - NULL if an error occurred.
+ */
+static struct cow_array_s *_alloc_array(int count) {
+    struct cow_array_s *array =
+        malloc(sizeof(struct cow_array_s) + count * sizeof(int));
+
+    if(array != NULL) {
+        array->count = count;
+    }
+
+    return array;
+}
+
+/*
+ * Publish a new version and retire the previous one. The writer mutex should
+ * be held.
+ *
+ * Parameters:
+ * - array: the new version.
+ */
+static void _publish(struct cow_array_s *array) {
+    struct cow_array_s *old =
+        atomic_load_explicit(&current, memory_order_relaxed);
+
+    // Readers that load the new version see its keys
+    atomic_store_explicit(&current, array, memory_order_release);
+    if(old != NULL) {
+        qsbr_retire(old);
+    }
+}
+
+static int _insert(int value) {
+    struct cow_array_s *old;
+    struct cow_array_s *temp;
+    int rv = 1;
+
+    pthread_mutex_lock(&mutex_w);
+
+    old = atomic_load_explicit(&current, memory_order_relaxed);
+    int count = old != NULL ? old->count : 0;
+    int rank = old != NULL ? _rank(old->keys, count, value) : 0;
+
+    if(rank < count && old->keys[rank] == value) { /* value in list */
+        rv = 0;
+    } else if((temp = _alloc_array(count + 1)) == NULL) {
+        rv = 0;
+    } else {
+        if(old != NULL) {
+            memcpy(temp->keys, old->keys, rank * sizeof(int));
+            memcpy(
+                &temp->keys[rank + 1], &old->keys[rank],
+                (count - rank) * sizeof(int)
+            );
+        }
+        temp->keys[rank] = value;
+        _publish(temp);
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+
+    return rv;
+}
+
+static void _print(void) {
+    struct cow_array_s *array = atomic_load(&current);
+
+    printf("list = ");
+    for(int i = 0; array != NULL && i < array->count; i++) {
+        printf("%d ", array->keys[i]);
+    }
+    printf("\n");
+}
+
+static int _member(int value) {
+    // The version stays valid until the calling thread announces its next
+    // quiescent state
+    struct cow_array_s *array =
+        atomic_load_explicit(&current, memory_order_acquire);
+
+    if(array == NULL) {
+        return 0;
+    }
+
+    int rank = _rank(array->keys, array->count, value);
+
+    return rank < array->count && array->keys[rank] == value;
+}
+
+static int _delete(int value) {
+    struct cow_array_s *old;
+    struct cow_array_s *temp;
+    int rv = 0;
+
+    pthread_mutex_lock(&mutex_w);
+
+    old = atomic_load_explicit(&current, memory_order_relaxed);
+    int count = old != NULL ? old->count : 0;
+    int rank = old != NULL ? _rank(old->keys, count, value) : 0;
+
+    if(rank < count && old->keys[rank] == value &&
+       (temp = _alloc_array(count - 1)) != NULL) {
+        memcpy(temp->keys, old->keys, rank * sizeof(int));
+        memcpy(
+            &temp->keys[rank], &old->keys[rank + 1],
+            (count - rank - 1) * sizeof(int)
+        );
+        _publish(temp);
+        rv = 1;
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+
+    return rv;
+}
+
+/*
+ * Insert a batch of values, merging them with the current version into a
+ * single new version.
+ */
+static int _insert_many(int *values, int count) {
+    struct cow_array_s *old;
+    struct cow_array_s *temp;
+    int inserted = 0;
+
+    set_sort_batch(values, count);
+
+    pthread_mutex_lock(&mutex_w);
+
+    old = atomic_load_explicit(&current, memory_order_relaxed);
+    int old_count = old != NULL ? old->count : 0;
+
+    if((temp = _alloc_array(old_count + count)) == NULL) {
+        pthread_mutex_unlock(&mutex_w);
+        return 0;
+    }
+
+    int i = 0, j = 0, n = 0;
+
+    while(i < old_count || j < count) {
+        if(j == count || (i < old_count && old->keys[i] < values[j])) {
+            temp->keys[n++] = old->keys[i++];
+        } else if(i < old_count && old->keys[i] == values[j]) {
+            j++; /* value in list */
+        } else if(n > 0 && temp->keys[n - 1] == values[j]) {
+            j++; /* value in batch twice */
+        } else {
+            temp->keys[n++] = values[j++];
+            inserted++;
+        }
+    }
+    temp->count = n;
+
+    if(inserted > 0) {
+        _publish(temp);
+    } else {
+        free(temp);
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+
+    return inserted;
+}
+
+static int _member_many(int *values, int count, int *results) {
+    struct cow_array_s *array =
+        atomic_load_explicit(&current, memory_order_acquire);
+    int found = 0;
+
+    set_sort_batch(values, count);
+
+    for(int i = 0; i < count; i++) {
+        int is_member = 0;
+
+        if(array != NULL) {
+            int rank = _rank(array->keys, array->count, values[i]);
+            is_member = rank < array->count && array->keys[rank] == values[i];
+        }
+        if(results != NULL) {
+            results[i] = is_member;
+        }
+        found += is_member;
+    }
+
+    return found;
+}
+
+/*
+ * Delete a batch of values, copying the keys that are not in the batch into
+ * a single new version.
+ */
+static int _delete_many(int *values, int count) {
+    struct cow_array_s *old;
+    struct cow_array_s *temp;
+    int deleted = 0;
+
+    set_sort_batch(values, count);
+
+    pthread_mutex_lock(&mutex_w);
+
+    old = atomic_load_explicit(&current, memory_order_relaxed);
+    int old_count = old != NULL ? old->count : 0;
+
+    if(old_count == 0 || (temp = _alloc_array(old_count)) == NULL) {
+        pthread_mutex_unlock(&mutex_w);
+        return 0;
+    }
+
+    int n = 0;
+
+    for(int i = 0, j = 0; i < old_count; i++) {
+        while(j < count && values[j] < old->keys[i]) {
+            j++;
+        }
+        if(j < count && values[j] == old->keys[i]) { /* value deleted */
+            deleted++;
+        } else {
+            temp->keys[n++] = old->keys[i];
+        }
+    }
+    temp->count = n;
+
+    if(deleted > 0) {
+        _publish(temp);
+    } else {
+        free(temp);
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+
+    return deleted;
+}
+
+static int _range_count(int lo, int hi) {
+    struct cow_array_s *array =
+        atomic_load_explicit(&current, memory_order_acquire);
+
+    if(array == NULL || lo >= hi) {
+        return 0;
+    }
+
+    return _rank(array->keys, array->count, hi) -
+           _rank(array->keys, array->count, lo);
+}
+
+/*
+ * Point the iterator inside the current version, which no writer modifies,
+ * so the snapshot costs two searches and no copy.
+ */
+static int _iterate(int lo, int hi, struct set_iterator_s *iterator) {
+    struct cow_array_s *array =
+        atomic_load_explicit(&current, memory_order_acquire);
+
+    set_iterator_init(iterator);
+    if(array == NULL || lo >= hi) {
+        return 0;
+    }
+
+    int begin = _rank(array->keys, array->count, lo);
+
+    iterator->keys = &array->keys[begin];
+    iterator->count = _rank(array->keys, array->count, hi) - begin;
+
+    return 0;
+}
+
+/*
+ * Copy the values into a version and publish it.
+ */
+static void _bulk_load(const int *values, int count) {
+    struct cow_array_s *temp;
+
+    pthread_mutex_lock(&mutex_w);
+
+    if((temp = _alloc_array(count)) != NULL) {
+        memcpy(temp->keys, values, count * sizeof(int));
+        _publish(temp);
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+}
+
+static void _free_list(void) {
+    free(atomic_load(&current));
+    atomic_store(&current, NULL);
+
+    // No thread is online anymore, every retired version can go
+    qsbr_reclaim();
+}
+
+const struct set_ops_s cow_array_set_ops = {
+    .name = "cow_array",
+    .synchronized = 1,
+    .insert = _insert,
+    .print = _print,
+    .member = _member,
+    .delete = _delete,
+    .free_list = _free_list,
+    .bulk_load = _bulk_load,
+    .thread_online = qsbr_thread_online,
+    .quiescent = qsbr_quiescent,
+    .thread_offline = qsbr_thread_offline,
+    .insert_many = _insert_many,
+    .member_many = _member_many,
+    .delete_many = _delete_many,
+    .range_count = _range_count,
+    .iterate = _iterate,
+};
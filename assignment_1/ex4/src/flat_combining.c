@@ -0,0 +1,340 @@
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "linkedlist.h"
+#ifdef NODE_POOL
+#include "node_pool.h"
+#endif
+#include "rwlock.h"
+#include "set.h"
+
+/* Size of a cache line in bytes */
+#define CACHE_LINE 64
+
+/* Checks of its request by a waiting thread between two yields */
+#define FC_SPINS 64
+
+/* The states of a publication record */
+#define FC_IDLE 0
+#define FC_PENDING 1
+#define FC_DONE 2
+
+/*
+ * The publication record of a thread, filling a whole cache line. The owner
+ * writes its request and then sets the state to FC_PENDING, the combiner
+ * writes the result and then sets the state to FC_DONE.
+ */
+struct fc_record_s {
+    _Alignas(CACHE_LINE) atomic_int state;
+    int value;
+    int insert;
+    int result;
+    /* Changed only by the combiner, once the record is published */
+    struct fc_record_s *next;
+    /* The generation of the set the record is published in, 0 if none */
+    unsigned long generation;
+};
+
+/* A request collected by the combiner */
+struct fc_request_s {
+    int value;
+    int insert;
+    /* The position of the request in the scan, that orders equal values */
+    int order;
+    struct fc_record_s *record;
+};
+
+static __thread struct fc_record_s self;
+
+/* The publication list, records are pushed at its head */
+static struct fc_record_s *_Atomic records = NULL;
+
+/* Set while a thread combines, or unlinks its record */
+static atomic_int combining = 0;
+
+/* Incremented by every init, so records of previous sets are not reused */
+static unsigned long generation = 0;
+
+/* The list, writers modify it only while combining */
+static list_t list = NULL;
+
+/* The buffers of the combiner */
+static struct fc_request_s *requests = NULL;
+static int *batch_values = NULL;
+static int *batch_inserts = NULL;
+static int *batch_results = NULL;
+static int capacity = 0;
+
+/*
+ * Compare two requests for qsort(), by value and then by order.
+ */
+static int _compare_requests(const void *a, const void *b) {
+    const struct fc_request_s *x = a;
+    const struct fc_request_s *y = b;
+
+    if(x->value != y->value) {
+        return (x->value > y->value) - (x->value < y->value);
+    }
+
+    return (x->order > y->order) - (x->order < y->order);
+}
+
+/*
+ * Double the buffers of the combiner. The combining flag should be set.
+ */
+static void _grow(void) {
+    capacity = capacity > 0 ? 2 * capacity : 16;
+    requests = realloc(requests, capacity * sizeof(struct fc_request_s));
+    batch_values = realloc(batch_values, capacity * sizeof(int));
+    batch_inserts = realloc(batch_inserts, capacity * sizeof(int));
+    batch_results = realloc(batch_results, capacity * sizeof(int));
+    if(requests == NULL || batch_values == NULL || batch_inserts == NULL ||
+       batch_results == NULL) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ * Push the record of the calling thread on the publication list, unless it
+ * is already published.
+ */
+static void _publish(void) {
+    if(self.generation == generation) {
+        return;
+    }
+
+    atomic_init(&self.state, FC_IDLE);
+    self.generation = generation;
+    self.next = atomic_load_explicit(&records, memory_order_relaxed);
+    while(!atomic_compare_exchange_weak_explicit(
+        &records, &self.next, &self, memory_order_release,
+        memory_order_relaxed
+    )) {
+    }
+}
+
+/*
+ * Apply every pending request with a single pass over the list, under its
+ * wrlock. The combining flag should be set.
+ */
+static void _combine(void) {
+    int count = 0;
+
+    for(struct fc_record_s *r =
+            atomic_load_explicit(&records, memory_order_acquire);
+        r != NULL; r = r->next) {
+        if(atomic_load_explicit(&r->state, memory_order_acquire) !=
+           FC_PENDING) {
+            continue;
+        }
+        if(count == capacity) {
+            _grow();
+        }
+        requests[count].value = r->value;
+        requests[count].insert = r->insert;
+        requests[count].order = count;
+        requests[count].record = r;
+        count++;
+    }
+
+    // Sort outside of the critical section
+    qsort(requests, count, sizeof(struct fc_request_s), _compare_requests);
+    for(int i = 0; i < count; i++) {
+        batch_values[i] = requests[i].value;
+        batch_inserts[i] = requests[i].insert;
+    }
+
+    if(rwlock_wrlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    list_update_many(
+        list, batch_values, batch_inserts, count, batch_results
+    );
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < count; i++) {
+        requests[i].record->result = batch_results[i];
+        atomic_store_explicit(
+            &requests[i].record->state, FC_DONE, memory_order_release
+        );
+    }
+}
+
+/*
+ * Publish an insert or a delete and wait until some thread, possibly the
+ * calling one, has combined it.
+ *
+ * Parameters:
+ * - value: the value to be inserted or deleted.
+ * - insert: 1 to insert the value, 0 to delete it.
+ *
+ * Returns:
+ * - the result of insert() or delete().
+ */
+static int _update(int value, int insert) {
+    _publish();
+
+    self.value = value;
+    self.insert = insert;
+    atomic_store_explicit(&self.state, FC_PENDING, memory_order_release);
+
+    for(int spins = 1;
+        atomic_load_explicit(&self.state, memory_order_acquire) != FC_DONE;
+        spins++) {
+        if(!atomic_load_explicit(&combining, memory_order_relaxed) &&
+           !atomic_exchange_explicit(&combining, 1, memory_order_acquire)) {
+            // The request was published before the flag was set, so the
+            // scan finds it unless an earlier combiner already applied it
+            _combine();
+            atomic_store_explicit(&combining, 0, memory_order_release);
+        } else if(spins % FC_SPINS == 0) {
+            sched_yield();
+        }
+    }
+    atomic_store_explicit(&self.state, FC_IDLE, memory_order_relaxed);
+
+    return self.result;
+}
+
+static int _init(const struct set_params_s *params) {
+    if(list_init(&list, params->lock_name) != 0) {
+        return 1;
+    }
+    list_use_fingers(list, params->fingers);
+    generation++;
+
+    return 0;
+}
+
+static int _insert(int value) { return _update(value, 1); }
+
+static int _member(int value) {
+    if(rwlock_rdlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_member(list, value);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+static int _delete(int value) { return _update(value, 0); }
+
+static void _print(void) { list_print(list); }
+
+static int _member_many(int *values, int count, int *results) {
+    if(rwlock_rdlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_member_many(list, values, count, results);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+static int _range_count(int lo, int hi) {
+    if(rwlock_rdlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_range_count(list, lo, hi);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+static int _iterate(int lo, int hi, struct set_iterator_s *iterator) {
+    if(rwlock_rdlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_iterate(list, lo, hi, iterator);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+static void _bulk_load(const int *values, int count) {
+    if(rwlock_wrlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    list_bulk_load(list, values, count);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void _free_list(void) {
+    list_destroy(&list);
+    free(requests);
+    free(batch_values);
+    free(batch_inserts);
+    free(batch_results);
+    requests = NULL;
+    batch_values = batch_inserts = batch_results = NULL;
+    capacity = 0;
+    atomic_store(&records, NULL);
+#ifdef NODE_POOL
+    // Every node was returned to the pool, release its slabs
+    node_pool_destroy();
+#endif
+}
+
+static void _thread_online(void) { _publish(); }
+
+/*
+ * Unlink the record of the calling thread from the publication list, so that
+ * the thread can exit.
+ */
+static void _thread_offline(void) {
+    if(self.generation != generation) {
+        return;
+    }
+
+    // No thread combines while the record is unlinked
+    while(atomic_exchange_explicit(&combining, 1, memory_order_acquire)) {
+        sched_yield();
+    }
+
+    struct fc_record_s *head = &self;
+
+    // Other threads only push records, so only the head can change
+    if(!atomic_compare_exchange_strong(&records, &head, self.next)) {
+        struct fc_record_s *pred = head;
+
+        while(pred->next != &self) {
+            pred = pred->next;
+        }
+        pred->next = self.next;
+    }
+
+    atomic_store_explicit(&combining, 0, memory_order_release);
+    self.generation = 0;
+}
+
+const struct set_ops_s flat_combining_set_ops = {
+    .name = "flat_combining",
+    .synchronized = 1,
+    .own_rwlocks = 1,
+    .init = _init,
+    .insert = _insert,
+    .print = _print,
+    .member = _member,
+    .delete = _delete,
+    .free_list = _free_list,
+    .bulk_load = _bulk_load,
+    .thread_online = _thread_online,
+    .thread_offline = _thread_offline,
+    .member_many = _member_many,
+    .range_count = _range_count,
+    .iterate = _iterate,
+};
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "histogram.h"
+
+unsigned long long histogram_time_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return (unsigned long long)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+void histogram_init(struct histogram_s *histogram) {
+    memset(histogram, 0, sizeof(struct histogram_s));
+}
+
+/*
+ * Get the bucket of a value. A value with its most significant bit at
+ * position m >= HISTOGRAM_SUB_BUCKET_BITS goes in the sub-bucket given by the
+ * HISTOGRAM_SUB_BUCKET_BITS bits that follow its most significant bit.
+ *
+ * Parameters:
+ * - value: the value.
+ *
+ * Returns:
+ * - the index of the bucket.
+ */
+int _histogram_bucket(unsigned long long value) {
+    if(value < HISTOGRAM_SUB_BUCKETS) {
+        return (int)value;
+    }
+
+    int shift = 63 - __builtin_clzll(value) - HISTOGRAM_SUB_BUCKET_BITS;
+    int sub_bucket = (int)(value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1);
+
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + sub_bucket;
+}
+
+/*
+ * Get the smallest value of a bucket.
+ *
+ * Parameters:
+ * - bucket: the index of the bucket.
+ *
+ * Returns:
+ * - the smallest value that goes in the bucket.
+ */
+unsigned long long _histogram_bucket_lower(int bucket) {
+    if(bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    unsigned long long sub_bucket = bucket % HISTOGRAM_SUB_BUCKETS;
+
+    return (HISTOGRAM_SUB_BUCKETS + sub_bucket) << shift;
+}
+
+/*
+ * Get the largest value of a bucket.
+ *
+ * Parameters:
+ * - bucket: the index of the bucket.
+ *
+ * Returns:
+ * - the largest value that goes in the bucket.
+ */
+unsigned long long _histogram_bucket_upper(int bucket) {
+    if(bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+
+    return _histogram_bucket_lower(bucket) + ((1ULL << shift) - 1);
+}
+
+void histogram_record(struct histogram_s *histogram, unsigned long long value) {
+    histogram->count++;
+    histogram->sum += value;
+    if(value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->buckets[_histogram_bucket(value)]++;
+}
+
+void histogram_merge(
+    struct histogram_s *destination, const struct histogram_s *source
+) {
+    destination->count += source->count;
+    destination->sum += source->sum;
+    if(source->max > destination->max) {
+        destination->max = source->max;
+    }
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        destination->buckets[i] += source->buckets[i];
+    }
+}
+
+unsigned long long histogram_percentile(
+    const struct histogram_s *histogram, double percentile
+) {
+    if(histogram->count == 0) {
+        return 0;
+    }
+
+    // The rank of the value of the percentile, starting from 1
+    unsigned long long rank =
+        (unsigned long long)(percentile / 100.0 * histogram->count + 0.5);
+    if(rank == 0) {
+        rank = 1;
+    }
+
+    unsigned long long seen = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if(seen >= rank) {
+            unsigned long long upper = _histogram_bucket_upper(i);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+void histogram_print_summary(
+    const struct histogram_s *histogram, const char *name
+) {
+    printf(
+        "%s: count = %llu, mean = %.1lf, p50 = %llu, p99 = %llu, "
+        "p99.9 = %llu, max = %llu\n",
+        name, histogram->count,
+        histogram->count ? (double)histogram->sum / histogram->count : 0.0,
+        histogram_percentile(histogram, 50.0),
+        histogram_percentile(histogram, 99.0),
+        histogram_percentile(histogram, 99.9), histogram->max
+    );
+}
+
+void histogram_print(const struct histogram_s *histogram, const char *name) {
+    histogram_print_summary(histogram, name);
+
+    // The sub-buckets of every power of two [2^(i-1), 2^i) are printed together
+    for(int i = 0; i <= 64; i++) {
+        unsigned long long lower = i == 0 ? 0 : 1ULL << (i - 1);
+        unsigned long long upper = i == 0 ? 0 : lower | (lower - 1);
+        unsigned long long count = 0;
+
+        for(int j = _histogram_bucket(lower); j <= _histogram_bucket(upper);
+            j++) {
+            count += histogram->buckets[j];
+        }
+        if(count > 0) {
+            printf("- [%llu, %llu]: %llu\n", lower, upper, count);
+        }
+    }
+}
@@ -1,16 +1,12 @@
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "linkedlist.h"
-
-/*
- * Check if list is empty.
- *
- * Returns:
- * - 0 if list is not empty.
- * - 1 if list is empty.
- */
-int _is_empty(void);
+#include "set.h"
+#ifdef NODE_POOL
+#include "node_pool.h"
+#endif
 
 /* Struct for list nodes */
 struct list_node_s {
@@ -18,26 +14,141 @@ struct list_node_s {
     struct list_node_s *next;
 };
 
-/* The head of the list */
-struct list_node_s *head = NULL;
+typedef struct List {
+    struct list_node_s *head;
+    /* The lock of the list, NULL if the caller synchronizes the list */
+    rwlock_t rwlock;
+    /* Unique among the lists of the process, 0 for the default list */
+    unsigned long id;
+    /* Incremented every time nodes are removed, invalidating the fingers */
+    unsigned long delete_epoch;
+    /* Searches start from the finger of the thread when they can */
+    int use_fingers;
+} list_s;
 
-int insert(int value) {
-    struct list_node_s *curr = head;
-    struct list_node_s *pred = NULL;
+/* The list of insert(), member(), delete() and the other global functions */
+static list_s default_list = {NULL, NULL, 0, 0, 0};
+
+/* The id of the next list */
+static atomic_ulong next_list_id = 1;
+
+/* Number of lists whose finger a thread remembers at the same time */
+#define FINGER_SLOTS 16
+
+/*
+ * The finger of a thread in a list: the last node that a search of the
+ * thread went past. The node is still in the list as long as the delete
+ * epoch of the list has not changed.
+ */
+struct finger_s {
+    unsigned long list_id;
+    unsigned long delete_epoch;
+    struct list_node_s *node;
+};
+
+/* The fingers of the thread, indexed by list id modulo FINGER_SLOTS */
+static __thread struct finger_s fingers[FINGER_SLOTS];
+
+/*
+ * Allocate a list node, either from the node pool or from the heap.
+ *
+ * Returns:
+ * - a pointer to the node.
+ * - NULL if an error occurred.
+ */
+struct list_node_s *_alloc_node(void) {
+#ifdef NODE_POOL
+    // The pool was initialized by list_init() or by the init of the set
+    return node_pool_alloc();
+#else
+    return malloc(sizeof(struct list_node_s));
+#endif
+}
+
+/*
+ * Free a list node, returning it to where it was allocated from.
+ *
+ * Parameters:
+ * - node: the node to be freed.
+ */
+void _free_node(struct list_node_s *node) {
+#ifdef NODE_POOL
+    node_pool_free(node);
+#else
+    free(node);
+#endif
+}
+
+/*
+ * Find where a search for a value can start: after the finger of the calling
+ * thread if it is still in the list and smaller than the value, otherwise at
+ * the head.
+ *
+ * Parameters:
+ * - list: the list.
+ * - value: the value to be searched.
+ * - pred_p: set to the node before the start (NULL for the head).
+ * - curr_p: set to the first node to be compared with the value.
+ */
+static void _search_start(
+    list_t list, int value, struct list_node_s **pred_p,
+    struct list_node_s **curr_p
+) {
+    struct finger_s *finger = &fingers[list->id % FINGER_SLOTS];
+
+    if(list->use_fingers && finger->node != NULL &&
+       finger->list_id == list->id &&
+       finger->delete_epoch == list->delete_epoch &&
+       finger->node->data < value) {
+        *pred_p = finger->node;
+        *curr_p = finger->node->next;
+    } else {
+        *pred_p = NULL;
+        *curr_p = list->head;
+    }
+}
+
+/*
+ * Remember the last node that a search went past as the finger of the
+ * calling thread.
+ *
+ * Parameters:
+ * - list: the list.
+ * - pred: the last node smaller than the searched value, NULL for none.
+ */
+static void _search_end(list_t list, struct list_node_s *pred) {
+    if(list->use_fingers && pred != NULL) {
+        struct finger_s *finger = &fingers[list->id % FINGER_SLOTS];
+
+        finger->list_id = list->id;
+        finger->delete_epoch = list->delete_epoch;
+        finger->node = pred;
+    }
+}
+
+void list_use_fingers(list_t list, int enabled) {
+    list->use_fingers = enabled;
+}
+
+int list_insert(list_t list, int value) {
+    struct list_node_s *curr;
+    struct list_node_s *pred;
     struct list_node_s *temp;
     int rv = 1;
 
+    _search_start(list, value, &pred, &curr);
     while(curr != NULL && curr->data < value) {
         pred = curr;
         curr = curr->next;
     }
+    _search_end(list, pred);
 
     if(curr == NULL || curr->data > value) {
-        temp = malloc(sizeof(struct list_node_s));
+        temp = _alloc_node();
         temp->data = value;
         temp->next = curr;
         if(pred == NULL)
-            head = temp;
+            list->head = temp;
         else
             pred->next = temp;
     } else { /* value in list */
@@ -47,12 +158,12 @@ int insert(int value) {
     return rv;
 }
 
-void print(void) {
+void list_print(list_t list) {
     struct list_node_s *temp;
 
     printf("list = ");
 
-    temp = head;
+    temp = list->head;
     while(temp != (struct list_node_s *)NULL) {
         printf("%d ", temp->data);
         temp = temp->next;
@@ -60,12 +171,16 @@ void print(void) {
     printf("\n");
 }
 
-int member(int value) {
+int list_member(list_t list, int value) {
     struct list_node_s *temp;
+    struct list_node_s *pred;
 
-    temp = head;
-    while(temp != NULL && temp->data < value)
+    _search_start(list, value, &pred, &temp);
+    while(temp != NULL && temp->data < value) {
+        pred = temp;
         temp = temp->next;
+    }
+    _search_end(list, pred);
 
     if(temp == NULL || temp->data > value) {
 #ifdef DEBUG
@@ -84,26 +199,28 @@ int member(int value) {
     }
 }
 
-int delete(int value) {
-    struct list_node_s *curr = head;
-    struct list_node_s *pred = NULL;
+int list_delete(list_t list, int value) {
+    struct list_node_s *curr;
+    struct list_node_s *pred;
     int rv = 1;
 
     /* Find value */
+    _search_start(list, value, &pred, &curr);
     while(curr != NULL && curr->data < value) {
         pred = curr;
         curr = curr->next;
     }
 
     if(curr != NULL && curr->data == value) {
+        list->delete_epoch++;
         if(pred == NULL) { /* first element in list */
-            head = curr->next;
+            list->head = curr->next;
 #ifdef DEBUG
             printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
             printf("DELETE(): Freeing %d\n", value);
             printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
 #endif
-            free(curr);
+            _free_node(curr);
         } else {
             pred->next = curr->next;
 #ifdef DEBUG
@@ -111,44 +228,410 @@ int delete(int value) {
             printf("DELETE(): Freeing %d\n", value);
             printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
 #endif
-            free(curr);
+            _free_node(curr);
         }
     } else { /* Not in list */
         rv = 0;
     }
+    _search_end(list, pred);
 
     return rv;
 }
 
-void free_list(void) {
-    struct list_node_s *current;
+int list_insert_upgradeable(list_t list, int value, rwlock_t *rwlock) {
+    struct list_node_s *curr;
+    struct list_node_s *pred;
+    struct list_node_s *temp;
+
+    _search_start(list, value, &pred, &curr);
+    while(curr != NULL && curr->data < value) {
+        pred = curr;
+        curr = curr->next;
+    }
+    _search_end(list, pred);
+
+    if(curr != NULL && curr->data == value) { /* value in list */
+        return 0;
+    }
+
+    // Only readers ran alongside the search, so pred and curr are still valid
+    if(rwlock_upgrade(rwlock) != 0) {
+        return -1;
+    }
+
+    temp = _alloc_node();
+    temp->data = value;
+    temp->next = curr;
+    if(pred == NULL)
+        list->head = temp;
+    else
+        pred->next = temp;
+
+    return 1;
+}
+
+int list_delete_upgradeable(list_t list, int value, rwlock_t *rwlock) {
+    struct list_node_s *curr;
+    struct list_node_s *pred;
+
+    /* Find value */
+    _search_start(list, value, &pred, &curr);
+    while(curr != NULL && curr->data < value) {
+        pred = curr;
+        curr = curr->next;
+    }
+
+    if(curr == NULL || curr->data != value) { /* Not in list */
+        _search_end(list, pred);
+        return 0;
+    }
+
+    // Only readers ran alongside the search, so pred and curr are still valid
+    if(rwlock_upgrade(rwlock) != 0) {
+        return -1;
+    }
+
+    list->delete_epoch++;
+    if(pred == NULL) /* first element in list */
+        list->head = curr->next;
+    else
+        pred->next = curr->next;
+#ifdef DEBUG
+    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    printf("DELETE(): Freeing %d\n", value);
+    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+#endif
+    _free_node(curr);
+    _search_end(list, pred);
+
+    return 1;
+}
+
+int list_insert_many(list_t list, int *values, int count) {
+    struct list_node_s *curr = list->head;
+    struct list_node_s *pred = NULL;
+    struct list_node_s *temp;
+    int inserted = 0;
+
+    set_sort_batch(values, count);
+
+    // Every value continues the walk where the previous one stopped
+    for(int i = 0; i < count; i++) {
+        int value = values[i];
+
+        while(curr != NULL && curr->data < value) {
+            pred = curr;
+            curr = curr->next;
+        }
+
+        if(curr != NULL && curr->data == value) { /* value in list */
+            continue;
+        }
+        if(pred != NULL && pred->data == value) { /* value in batch twice */
+            continue;
+        }
+
+        temp = _alloc_node();
+        temp->data = value;
+        temp->next = curr;
+        if(pred == NULL)
+            list->head = temp;
+        else
+            pred->next = temp;
+        pred = temp;
+        inserted++;
+    }
+
+    return inserted;
+}
+
+int list_member_many(list_t list, int *values, int count, int *results) {
+    struct list_node_s *temp = list->head;
+    int found = 0;
+
+    set_sort_batch(values, count);
+
+    for(int i = 0; i < count; i++) {
+        while(temp != NULL && temp->data < values[i])
+            temp = temp->next;
+
+        int is_member = (temp != NULL && temp->data == values[i]);
+
+        if(results != NULL) {
+            results[i] = is_member;
+        }
+        found += is_member;
+    }
+
+    return found;
+}
+
+int list_delete_many(list_t list, int *values, int count) {
+    struct list_node_s *curr = list->head;
+    struct list_node_s *pred = NULL;
+    int deleted = 0;
+
+    set_sort_batch(values, count);
+
+    for(int i = 0; i < count; i++) {
+        while(curr != NULL && curr->data < values[i]) {
+            pred = curr;
+            curr = curr->next;
+        }
+
+        if(curr == NULL || curr->data != values[i]) { /* Not in list */
+            continue;
+        }
+
+        list->delete_epoch++;
+        if(pred == NULL) /* first element in list */
+            list->head = curr->next;
+        else
+            pred->next = curr->next;
+#ifdef DEBUG
+        printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+        printf("DELETE(): Freeing %d\n", values[i]);
+        printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+#endif
+        _free_node(curr);
+        curr = (pred == NULL) ? list->head : pred->next;
+        deleted++;
+    }
+
+    return deleted;
+}
+
+int list_update_many(
+    list_t list, const int *values, const int *inserts, int count,
+    int *results
+) {
+    struct list_node_s *curr = list->head;
+    struct list_node_s *pred = NULL;
+    struct list_node_s *temp;
+    int updated = 0;
+
+    for(int i = 0; i < count; i++) {
+        int value = values[i];
+
+        while(curr != NULL && curr->data < value) {
+            pred = curr;
+            curr = curr->next;
+        }
+
+        int in_list = (curr != NULL && curr->data == value);
+
+        if(inserts[i] && !in_list) {
+            temp = _alloc_node();
+            temp->data = value;
+            temp->next = curr;
+            if(pred == NULL)
+                list->head = temp;
+            else
+                pred->next = temp;
+            // The next request for the same value finds the new node
+            curr = temp;
+        } else if(!inserts[i] && in_list) {
+            list->delete_epoch++;
+            if(pred == NULL)
+                list->head = curr->next;
+            else
+                pred->next = curr->next;
+            _free_node(curr);
+            curr = (pred == NULL) ? list->head : pred->next;
+        }
+
+        results[i] = inserts[i] ? !in_list : in_list;
+        updated += results[i];
+    }
+
+    return updated;
+}
+
+void list_bulk_load(list_t list, const int *values, int count) {
+    struct list_node_s *temp;
+
+    // Link from the largest value, every node becomes the new head
+    for(int i = count - 1; i >= 0; i--) {
+        temp = _alloc_node();
+        temp->data = values[i];
+        temp->next = list->head;
+        list->head = temp;
+    }
+}
+
+int list_range_count(list_t list, int lo, int hi) {
+    struct list_node_s *temp = list->head;
+    int count = 0;
+
+    while(temp != NULL && temp->data < lo)
+        temp = temp->next;
+    while(temp != NULL && temp->data < hi) {
+        count++;
+        temp = temp->next;
+    }
+
+    return count;
+}
+
+int list_iterate(list_t list, int lo, int hi, struct set_iterator_s *iterator) {
+    struct list_node_s *temp = list->head;
+
+    set_iterator_init(iterator);
+
+    while(temp != NULL && temp->data < lo)
+        temp = temp->next;
+    while(temp != NULL && temp->data < hi) {
+        if(set_iterator_append(iterator, temp->data) != 0) {
+            set_iterator_destroy(iterator);
+            return 1;
+        }
+        temp = temp->next;
+    }
+
+    return 0;
+}
+
+int list_init(list_t *list, const char *lock_name) {
+    if((*list = malloc(sizeof(list_s))) == NULL) {
+        return 1;
+    }
+
+    (*list)->head = NULL;
+    (*list)->rwlock = NULL;
+    (*list)->id = atomic_fetch_add(&next_list_id, 1);
+    (*list)->delete_epoch = 0;
+    (*list)->use_fingers = 0;
+#ifdef NODE_POOL
+    if(node_pool_init(sizeof(struct list_node_s)) != 0) {
+        free(*list);
+        *list = NULL;
+        return 1;
+    }
+#endif
+    if(lock_name != NULL && rwlock_init(&(*list)->rwlock, lock_name) != 0) {
+        free(*list);
+        *list = NULL;
+        return 1;
+    }
+
+    return 0;
+}
+
+rwlock_t *list_rwlock(list_t list) { return &list->rwlock; }
+
+void list_clear(list_t list) {
+    struct list_node_s *current = list->head;
     struct list_node_s *following;
 
-    if(_is_empty())
-        return;
-    current = head;
-    following = current->next;
-    while(following != NULL) {
+    while(current != NULL) {
 #ifdef DEBUG
         printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
         printf("FREE_LIST(): Freeing %d\n", current->data);
         printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
 #endif
-        free(current);
-        current = following;
         following = current->next;
+        _free_node(current);
+        current = following;
     }
-#ifdef DEBUG
-    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-    printf("FREE_LIST(): Freeing %d\n", current->data);
-    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-#endif
-    free(current);
+    list->head = NULL;
+    list->delete_epoch++;
+}
+
+int list_destroy(list_t *list) {
+    int ret = 0;
+
+    list_clear(*list);
+    if((*list)->rwlock != NULL && (ret = rwlock_destroy(&(*list)->rwlock))) {
+        return ret;
+    }
+
+    free(*list);
+    *list = NULL;
+
+    return 0;
 }
 
-int _is_empty(void) {
-    if(head == NULL)
+int insert(int value) { return list_insert(&default_list, value); }
+
+void print(void) { list_print(&default_list); }
+
+int member(int value) { return list_member(&default_list, value); }
+
+int delete(int value) { return list_delete(&default_list, value); }
+
+int insert_upgradeable(int value, rwlock_t *rwlock) {
+    return list_insert_upgradeable(&default_list, value, rwlock);
+}
+
+int delete_upgradeable(int value, rwlock_t *rwlock) {
+    return list_delete_upgradeable(&default_list, value, rwlock);
+}
+
+int insert_many(int *values, int count) {
+    return list_insert_many(&default_list, values, count);
+}
+
+int member_many(int *values, int count, int *results) {
+    return list_member_many(&default_list, values, count, results);
+}
+
+int delete_many(int *values, int count) {
+    return list_delete_many(&default_list, values, count);
+}
+
+void bulk_load(const int *values, int count) {
+    list_bulk_load(&default_list, values, count);
+}
+
+int range_count(int lo, int hi) {
+    return list_range_count(&default_list, lo, hi);
+}
+
+int iterate(int lo, int hi, struct set_iterator_s *iterator) {
+    return list_iterate(&default_list, lo, hi, iterator);
+}
+
+/*
+ * Initialize the node pool, outside of the critical sections, and enable the
+ * fingers of the default list if the parameters ask for them.
+ */
+static int _init(const struct set_params_s *params) {
+#ifdef NODE_POOL
+    if(node_pool_init(sizeof(struct list_node_s)) != 0) {
         return 1;
-    else
-        return 0;
-}
\ No newline at end of file
+    }
+#endif
+    list_use_fingers(&default_list, params->fingers);
+
+    return 0;
+}
+
+void free_list(void) {
+#ifdef NODE_POOL
+    // The default list is the only set of the run and every node lives in a
+    // slab of the pool, release them all at once
+    node_pool_destroy();
+    default_list.head = NULL;
+    default_list.delete_epoch++;
+#else
+    list_clear(&default_list);
+#endif
+}
+
+const struct set_ops_s list_set_ops = {
+    .name = "list",
+    .init = _init,
+    .insert = insert,
+    .print = print,
+    .member = member,
+    .delete = delete,
+    .free_list = free_list,
+    .insert_upgradeable = insert_upgradeable,
+    .delete_upgradeable = delete_upgradeable,
+    .insert_many = insert_many,
+    .member_many = member_many,
+    .delete_many = delete_many,
+    .bulk_load = bulk_load,
+    .range_count = range_count,
+    .iterate = iterate,
+};
@@ -1,11 +1,20 @@
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include "linkedlist.h"
+#include "histogram.h"
 #include "my_rand.h"
+#ifdef NODE_POOL
+#include "node_pool.h"
+#endif
+#include "prefill.h"
 #include "rwlock.h"
+#include "set.h"
 #include "timer.h"
+#include "trace.h"
+#include "workload.h"
 
 /* Random ints are less than MAX_KEY */
 const int MAX_KEY = 1e8;
@@ -17,11 +26,56 @@ double insert_percent;
 double search_percent;
 double delete_percent;
 
+const char *lock_name = "default";
+const char *set_name = "list";
+int sweep = 0;
+int upgradeable = 0;
+int batch_size = 1;
+const char *distribution = "uniform";
+const char *phases = NULL;
+int partitioned = 0;
+int shard_count = 16;
+const char *trace_in = NULL;
+const char *trace_out = NULL;
+int scan_width = 0;
+int fingers = 0;
+
+struct workload_s workload;
+
+/* The operations of every thread, generated or replayed before any run */
+const struct operation_s **thread_ops;
+/* The number of operations of every thread */
+int *thread_op_counts;
+
+/* The replayed trace, the operations point inside its mapping */
+struct trace_s trace;
+
+/* The sorted keys inserted before the threads start, generated once */
+int *initial_keys;
+int initial_count;
+
 rwlock_t rwlock;
+const struct set_ops_s *set;
 pthread_mutex_t count_mutex;
 
 int member_count = 0, insert_count = 0, delete_count = 0;
 
+/* Every phase starts when all the threads have finished the previous one */
+pthread_barrier_t phase_barrier;
+/* Timestamps of the start of every phase and of the end of the last one */
+unsigned long long phase_start[WORKLOAD_MAX_PHASES + 1];
+/* Latencies of the operations (of the batches with -b) of every phase */
+struct histogram_s phase_latency[WORKLOAD_MAX_PHASES];
+/* Latencies of every operation, indexed by OP_* */
+struct histogram_s op_latency[3];
+
+/* Set when the analytics thread of -x should stop scanning */
+atomic_int scan_stop;
+/* The scans of the analytics thread, their latencies and the keys they saw */
+int scan_count;
+long long scanned_keys;
+struct histogram_s scan_latency;
+
 /*
  * Get the arguments from the command line. The arguments are:
  * -t: number of threads.
@@ -30,10 +84,35 @@ int member_count = 0, insert_count = 0, delete_count = 0;
  * -s: percentage of search operations.
  * -i: percentage of insert operations.
  * -d: percentage of delete operations.
- * It is required that all the arguments are passed.
+ * It is required that all the above arguments are passed. The optional
+ * arguments are:
+ * -l: the rwlock implementation, see rwlock_init() (default: "default").
+ * -S: the set implementation, see set_find() (default: "list").
+ * -a: run every combination of rwlock and set implementations (sweep mode),
+ * ignoring -l and -S.
+ * -u: search for inserts and deletes with the rwlock in upgradeable mode,
+ * upgrading it only to modify the set, if the set supports it.
+ * -b: split the operations of every thread in batches of this many
+ * operations, see _work_batched() (default: 1, no batches).
+ * -D: the key distribution, see workload_parse_distribution() (default:
+ * "uniform").
+ * -P: the phases, see workload_parse_phases(), overriding -s, -i and -d
+ * (default: a single phase).
+ * -r: every thread draws its keys from its own range of keys.
+ * -n: the number of shards of the sharded sets (default: 16).
+ * -R: replay the operations of a trace file, see trace_open(), instead of
+ * generating them. The trace sets the thread count and the operations, so
+ * -t, -o, -s, -i, -d, -D and -r are ignored, and -P only sets where the
+ * phases begin.
+ * -w: write the generated operations to a trace file, see trace_write().
+ * -x: run an analytics thread besides the others, which repeatedly iterates
+ * over a snapshot of a random range of this many keys, see scan_work()
+ * (default: 0, no analytics thread).
+ * -f: start the searches of every thread from the last node its previous
+ * search went past, when the set supports it (see list_use_fingers()).
  *
  * Example:
- * main -t 4 -k 100000 -o 1000 -s 0.7 -i 0.2 -d 0.1
+ * main -t 4 -k 100000 -o 1000 -s 0.7 -i 0.2 -d 0.1 -l phase_fair -S unrolled
  *
  * Parameters:
  * - argc: number of arguments of main.
@@ -47,8 +126,81 @@ int member_count = 0, insert_count = 0, delete_count = 0;
  */
 int arg_parser(int argc, char *argv[], int *inserts_in_main_p);
 
+/*
+ * Generate the operations of every thread, drawing from the same random
+ * sequence of each thread in every run.
+ *
+ * Returns:
+ * - 0 if the operations were generated successfully.
+ * - 1 if an error occurred.
+ */
+int generate_operations(void);
+
+/*
+ * Fill the set with the initial keys, run the threads over the pre-generated
+ * operations and print the results, then empty the set.
+ *
+ * Returns:
+ * - 0 if the run completed successfully.
+ * - 1 if an error occurred.
+ */
+int run(void);
+
 void *thread_work(void *rank);
 
+/*
+ * Iterate over snapshots of random ranges of scan_width keys until
+ * scan_stop is set, as an analytics job would while the other threads
+ * modify the set. Only taking the snapshot holds the rwlock.
+ *
+ * Parameters:
+ * - unused: unused.
+ *
+ * Returns:
+ * - NULL.
+ */
+void *scan_work(void *unused);
+
+/*
+ * Perform a range of operations one at a time.
+ *
+ * Parameters:
+ * - ops: the operations of the thread.
+ * - begin: the first operation.
+ * - end: the operation after the last one.
+ * - latency: the histogram that receives the latency of every operation.
+ * - op_latency: the histograms that receive the latency of every operation,
+ * indexed by OP_*.
+ * - counts: the operation counts of the thread, indexed by OP_*.
+ */
+void _work(
+    const struct operation_s *ops, int begin, int end,
+    struct histogram_s *latency, struct histogram_s *op_latency, int *counts
+);
+
+/*
+ * Perform a range of operations batch_size at a time. The keys of a batch are
+ * grouped by operation and sorted before taking the rwlock, then the searches
+ * run under one read lock and the inserts and deletes under one write lock,
+ * through the batched operations of the set when it has them.
+ *
+ * Parameters:
+ * - ops: the operations of the thread.
+ * - begin: the first operation.
+ * - end: the operation after the last one.
+ * - latency: the histogram that receives the latency of every batch.
+ * - op_latency: the histograms that receive the latency of the read section
+ * (OP_MEMBER) and of the write section (OP_INSERT and OP_DELETE, if the batch
+ * has any of them) of every batch.
+ * - counts: the operation counts of the thread, indexed by OP_*.
+ * - keys: room for 3 * batch_size keys.
+ */
+void _work_batched(
+    const struct operation_s *ops, int begin, int end,
+    struct histogram_s *latency, struct histogram_s *op_latency, int *counts,
+    int *keys
+);
+
 int main(int argc, char *argv[]) {
     int inserts_in_main;
 
@@ -56,33 +208,179 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    long i = 0;
-    unsigned seed = 1;
-    int key, success, attempts = 0;
-    /* Try to insert inserts_in_main keys, but give up after */
-    /* 2*inserts_in_main attempts.                           */
-    while(i < inserts_in_main && attempts < 2 * inserts_in_main) {
-        key = my_rand(&seed) % MAX_KEY;
-        success = insert(key);
-        attempts++;
-        if(success) {
-            i++;
+    if(trace_in != NULL) {
+        if(trace_open(&trace, trace_in)) {
+            fprintf(stderr, "Could not replay the trace: %s\n", trace_in);
+            return 1;
+        }
+        thread_count = trace.thread_count;
+        total_ops = (int)trace.record_count;
+        thread_ops = trace.thread_ops;
+        thread_op_counts = trace.thread_counts;
+    } else if(generate_operations()) {
+        fprintf(stderr, "Could not allocate the operations\n");
+        return 1;
+    }
+
+    if(trace_out != NULL &&
+       trace_write(trace_out, thread_ops, thread_op_counts, thread_count)) {
+        fprintf(stderr, "Could not write the trace: %s\n", trace_out);
+        return 1;
+    }
+
+    // The keys that inserting seed 1 keys one at a time would leave
+    if(prefill_generate(
+           inserts_in_main, MAX_KEY, 1, thread_count, &initial_keys,
+           &initial_count
+       )) {
+        fprintf(stderr, "Could not allocate the initial keys\n");
+        return 1;
+    }
+
+    pthread_mutex_init(&count_mutex, NULL);
+
+    int ret = 0;
+
+    if(sweep) {
+        for(int i = 0; i < rwlock_implementation_count() && ret == 0; i++) {
+            for(int j = 0; j < set_implementation_count() && ret == 0; j++) {
+                lock_name = rwlock_implementation_name(i);
+                set = set_implementation(j);
+                // A set that takes no rwlock runs once
+                if(set->synchronized && !set->own_rwlocks && i > 0) {
+                    continue;
+                }
+                ret = run();
+            }
+        }
+    } else {
+        if((set = set_find(set_name)) == NULL) {
+            fprintf(stderr, "Unknown set implementation: %s\n", set_name);
+            ret = 1;
+        } else {
+            ret = run();
+        }
+    }
+
+#ifdef NODE_POOL
+    node_pool_print_stats();
+#endif
+    pthread_mutex_destroy(&count_mutex);
+    if(trace_in != NULL) {
+        trace_close(&trace);
+    } else {
+        for(int i = 0; i < thread_count; i++) {
+            free((struct operation_s *)thread_ops[i]);
+        }
+        free(thread_ops);
+        free(thread_op_counts);
+    }
+    free(initial_keys);
+
+    return ret;
+}
+
+int generate_operations(void) {
+    int ops_per_thread = total_ops / thread_count;
+
+    thread_ops = calloc(thread_count, sizeof(struct operation_s *));
+    thread_op_counts = calloc(thread_count, sizeof(int));
+    if(thread_ops == NULL || thread_op_counts == NULL) {
+        return 1;
+    }
+
+    for(long rank = 0; rank < thread_count; rank++) {
+        struct operation_s *ops =
+            malloc(ops_per_thread * sizeof(struct operation_s));
+        if((thread_ops[rank] = ops) == NULL && ops_per_thread > 0) {
+            return 1;
+        }
+        thread_op_counts[rank] = ops_per_thread;
+
+        if(workload_generate(
+               &workload, rank, thread_count, ops, ops_per_thread
+           )) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int run(void) {
+    if(!set->synchronized && rwlock_init(&rwlock, lock_name) != 0) {
+        fprintf(stderr, "Unknown rwlock implementation: %s\n", lock_name);
+        return 1;
+    }
+
+    if(set->init != NULL) {
+        struct set_params_s params = {
+            lock_name, shard_count, MAX_KEY, fingers
+        };
+
+        if(set->init(&params) != 0) {
+            fprintf(stderr, "Could not initialize the set %s\n", set->name);
+            if(!set->synchronized) {
+                rwlock_destroy(&rwlock);
+            }
+            return 1;
+        }
+    }
+
+    printf(
+        "Lock = %s\n",
+        set->synchronized && !set->own_rwlocks ? "none" : lock_name
+    );
+    printf("Set = %s\n", set->name);
+    if(set->own_rwlocks) {
+        printf("Shards = %d\n", shard_count);
+    }
+    if(fingers) {
+        printf("Fingers = on\n");
+    }
+
+    long i;
+
+    if(set->bulk_load != NULL) {
+        set->bulk_load(initial_keys, initial_count);
+    } else {
+        // From the largest key, a sorted list finds its place at the head
+        for(i = initial_count - 1; i >= 0; i--) {
+            set->insert(initial_keys[i]);
         }
     }
 
-    printf("Initial keys = %ld\n", i);
+    printf("Initial keys = %d\n", initial_count);
 
 #ifdef OUTPUT
     printf("Before starting threads, list = \n");
-    print();
+    set->print();
     printf("\n");
 #endif
 
     pthread_t *thread_handles;
     thread_handles = malloc(thread_count * sizeof(pthread_t));
 
-    pthread_mutex_init(&count_mutex, NULL);
-    rwlock_init(&rwlock);
+    member_count = 0;
+    insert_count = 0;
+    delete_count = 0;
+    for(i = 0; i < workload.phase_count; i++) {
+        histogram_init(&phase_latency[i]);
+    }
+    for(i = 0; i < 3; i++) {
+        histogram_init(&op_latency[i]);
+    }
+    pthread_barrier_init(&phase_barrier, NULL, thread_count);
+
+    pthread_t scan_handle;
+
+    scan_count = 0;
+    scanned_keys = 0;
+    histogram_init(&scan_latency);
+    atomic_store(&scan_stop, 0);
+    if(scan_width > 0) {
+        pthread_create(&scan_handle, NULL, scan_work, NULL);
+    }
 
     double start, finish;
     GET_TIME(start);
@@ -94,21 +392,53 @@ int main(int argc, char *argv[]) {
     }
     GET_TIME(finish);
 
+    if(scan_width > 0) {
+        atomic_store(&scan_stop, 1);
+        pthread_join(scan_handle, NULL);
+    }
+
     printf("Elapsed time = %lf seconds\n", finish - start);
     printf("Total ops = %d\n", total_ops);
     printf("member ops = %d\n", member_count);
     printf("insert ops = %d\n", insert_count);
     printf("delete ops = %d\n", delete_count);
+    histogram_print_summary(&op_latency[OP_MEMBER], "member latency (ns)");
+    histogram_print_summary(&op_latency[OP_INSERT], "insert latency (ns)");
+    histogram_print_summary(&op_latency[OP_DELETE], "delete latency (ns)");
+    if(scan_width > 0) {
+        printf("Scans = %d, keys scanned = %lld\n", scan_count, scanned_keys);
+        histogram_print_summary(&scan_latency, "scan latency (ns)");
+    }
+
+    for(i = 0; i < workload.phase_count; i++) {
+        int ops = 0;
+        for(int j = 0; j < thread_count; j++) {
+            ops += workload_phase_begin(&workload, i + 1, thread_op_counts[j]) -
+                   workload_phase_begin(&workload, i, thread_op_counts[j]);
+        }
+        double elapsed = (phase_start[i + 1] - phase_start[i]) / 1e9;
+        char name[64];
+
+        printf(
+            "Phase %ld: ops = %d, elapsed time = %lf seconds, "
+            "throughput = %.0lf ops/s\n",
+            i, ops, elapsed, elapsed > 0 ? ops / elapsed : 0.0
+        );
+        snprintf(name, sizeof(name), "Phase %ld latency (ns)", i);
+        histogram_print_summary(&phase_latency[i], name);
+    }
 
 #ifdef OUTPUT
     printf("After threads terminate, list = \n");
-    print();
+    set->print();
     printf("\n");
 #endif
 
-    free_list();
-    rwlock_destroy(&rwlock);
-    pthread_mutex_destroy(&count_mutex);
+    set->free_list();
+    if(!set->synchronized) {
+        rwlock_destroy(&rwlock);
+    }
+    pthread_barrier_destroy(&phase_barrier);
     free(thread_handles);
 
     return 0;
@@ -116,57 +446,312 @@ int main(int argc, char *argv[]) {
 
 void *thread_work(void *rank) {
     long my_rank = (long)rank;
-    int ops_per_thread = total_ops / thread_count;
+    int ops_per_thread = thread_op_counts[my_rank];
+    const struct operation_s *ops = thread_ops[my_rank];
+
+    int my_counts[3] = {0, 0, 0};
+    int *keys = NULL;
+
+    // The histograms of the operations, then those of the phases
+    struct histogram_s *my_op_latency =
+        malloc((3 + workload.phase_count) * sizeof(struct histogram_s));
+    struct histogram_s *my_latency = my_op_latency + 3;
+
+    if(my_op_latency == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    for(int i = 0; i < 3; i++) {
+        histogram_init(&my_op_latency[i]);
+    }
 
+    if(batch_size > 1) {
+        if((keys = malloc(3 * batch_size * sizeof(int))) == NULL) {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if(set->thread_online != NULL) {
+        set->thread_online();
+    }
+
+    for(int phase = 0; phase <= workload.phase_count; phase++) {
+        pthread_barrier_wait(&phase_barrier);
+        if(my_rank == 0) {
+            phase_start[phase] = histogram_time_ns();
+        }
+        if(phase == workload.phase_count) {
+            break;
+        }
+
+        int begin = workload_phase_begin(&workload, phase, ops_per_thread);
+        int end = workload_phase_begin(&workload, phase + 1, ops_per_thread);
+
+        histogram_init(&my_latency[phase]);
+        if(batch_size > 1) {
+            _work_batched(
+                ops, begin, end, &my_latency[phase], my_op_latency, my_counts,
+                keys
+            );
+        } else {
+            _work(
+                ops, begin, end, &my_latency[phase], my_op_latency, my_counts
+            );
+        }
+    }
+
+    if(set->thread_offline != NULL) {
+        set->thread_offline();
+    }
+
+    free(keys);
+
+    pthread_mutex_lock(&count_mutex);
+    member_count += my_counts[OP_MEMBER];
+    insert_count += my_counts[OP_INSERT];
+    delete_count += my_counts[OP_DELETE];
+    for(int phase = 0; phase < workload.phase_count; phase++) {
+        histogram_merge(&phase_latency[phase], &my_latency[phase]);
+    }
+    for(int i = 0; i < 3; i++) {
+        histogram_merge(&op_latency[i], &my_op_latency[i]);
+    }
+    pthread_mutex_unlock(&count_mutex);
+
+    free(my_op_latency);
+
+#ifdef NODE_POOL
+    node_pool_thread_exit();
+#endif
+
+    return NULL;
+}
+
+void _work(
+    const struct operation_s *ops, int begin, int end,
+    struct histogram_s *latency, struct histogram_s *op_latency, int *counts
+) {
     int i, val;
-    double which_op;
-    unsigned seed = my_rank + 1;
-    int my_member_count = 0, my_insert_count = 0, my_delete_count = 0;
-
-    for(i = 0; i < ops_per_thread; i++) {
-        which_op = my_drand(&seed);
-        val = my_rand(&seed) % MAX_KEY;
-        if(which_op < search_percent) {
-            if(rwlock_rdlock(&rwlock) != 0) {
+
+    for(i = begin; i < end; i++) {
+        unsigned long long start = histogram_time_ns();
+
+        val = ops[i].key;
+        if(ops[i].type == OP_MEMBER) {
+            if(!set->synchronized && rwlock_rdlock(&rwlock) != 0) {
                 exit(EXIT_FAILURE);
             };
-            member(val);
-            if(rwlock_unlock(&rwlock) != 0) {
+            set->member(val);
+            if(!set->synchronized && rwlock_unlock(&rwlock) != 0) {
                 exit(EXIT_FAILURE);
             }
-            my_member_count++;
-        } else if(which_op < search_percent + insert_percent) {
-            if(rwlock_wrlock(&rwlock) != 0) {
+        } else if(ops[i].type == OP_INSERT) {
+#ifdef NODE_POOL
+            node_pool_reserve();
+#endif
+            if(upgradeable && set->insert_upgradeable != NULL) {
+                if(rwlock_rdlock_upgradeable(&rwlock) != 0) {
+                    exit(EXIT_FAILURE);
+                };
+                if(set->insert_upgradeable(val, &rwlock) < 0) {
+                    exit(EXIT_FAILURE);
+                };
+            } else {
+                if(!set->synchronized && rwlock_wrlock(&rwlock) != 0) {
+                    exit(EXIT_FAILURE);
+                };
+                set->insert(val);
+            }
+            if(!set->synchronized && rwlock_unlock(&rwlock) != 0) {
                 exit(EXIT_FAILURE);
             };
-            insert(val);
-            if(rwlock_unlock(&rwlock) != 0) {
+        } else { /* delete */
+            if(upgradeable && set->delete_upgradeable != NULL) {
+                if(rwlock_rdlock_upgradeable(&rwlock) != 0) {
+                    exit(EXIT_FAILURE);
+                };
+                if(set->delete_upgradeable(val, &rwlock) < 0) {
+                    exit(EXIT_FAILURE);
+                };
+            } else {
+                if(!set->synchronized && rwlock_wrlock(&rwlock) != 0) {
+                    exit(EXIT_FAILURE);
+                };
+                set->delete(val);
+            }
+            if(!set->synchronized && rwlock_unlock(&rwlock) != 0) {
                 exit(EXIT_FAILURE);
             };
-            my_insert_count++;
-        } else { /* delete */
-            if(rwlock_wrlock(&rwlock) != 0) {
+#ifdef NODE_POOL
+            node_pool_trim();
+#endif
+        }
+        counts[ops[i].type]++;
+
+        if(set->quiescent != NULL) {
+            set->quiescent();
+        }
+
+        unsigned long long elapsed = histogram_time_ns() - start;
+
+        histogram_record(latency, elapsed);
+        histogram_record(&op_latency[ops[i].type], elapsed);
+    }
+}
+
+void _work_batched(
+    const struct operation_s *ops, int begin, int end,
+    struct histogram_s *latency, struct histogram_s *op_latency, int *counts,
+    int *keys
+) {
+    int *members = keys;
+    int *inserts = members + batch_size;
+    int *deletes = inserts + batch_size;
+
+    for(int i = begin; i < end; i += batch_size) {
+        unsigned long long start = histogram_time_ns();
+        int members_n = 0, inserts_n = 0, deletes_n = 0;
+
+        for(int j = i; j < i + batch_size && j < end; j++) {
+            if(ops[j].type == OP_MEMBER) {
+                members[members_n++] = ops[j].key;
+            } else if(ops[j].type == OP_INSERT) {
+                inserts[inserts_n++] = ops[j].key;
+            } else {
+                deletes[deletes_n++] = ops[j].key;
+            }
+        }
+
+        // Sort outside of the critical sections
+        qsort(members, members_n, sizeof(int), set_compare_keys);
+        qsort(inserts, inserts_n, sizeof(int), set_compare_keys);
+        qsort(deletes, deletes_n, sizeof(int), set_compare_keys);
+
+        if(members_n > 0) {
+            unsigned long long section_start = histogram_time_ns();
+
+            if(!set->synchronized && rwlock_rdlock(&rwlock) != 0) {
                 exit(EXIT_FAILURE);
             };
-            delete(val);
-            if(rwlock_unlock(&rwlock) != 0) {
+            if(set->member_many != NULL) {
+                set->member_many(members, members_n, NULL);
+            } else {
+                for(int j = 0; j < members_n; j++) {
+                    set->member(members[j]);
+                }
+            }
+            if(!set->synchronized && rwlock_unlock(&rwlock) != 0) {
+                exit(EXIT_FAILURE);
+            }
+            histogram_record(
+                &op_latency[OP_MEMBER], histogram_time_ns() - section_start
+            );
+        }
+
+        if(inserts_n > 0 || deletes_n > 0) {
+            unsigned long long section_start = histogram_time_ns();
+
+#ifdef NODE_POOL
+            node_pool_reserve();
+#endif
+            if(!set->synchronized && rwlock_wrlock(&rwlock) != 0) {
+                exit(EXIT_FAILURE);
+            };
+            if(set->insert_many != NULL) {
+                set->insert_many(inserts, inserts_n);
+            } else {
+                for(int j = 0; j < inserts_n; j++) {
+                    set->insert(inserts[j]);
+                }
+            }
+            if(set->delete_many != NULL) {
+                set->delete_many(deletes, deletes_n);
+            } else {
+                for(int j = 0; j < deletes_n; j++) {
+                    set->delete(deletes[j]);
+                }
+            }
+            if(!set->synchronized && rwlock_unlock(&rwlock) != 0) {
                 exit(EXIT_FAILURE);
             };
-            my_delete_count++;
+#ifdef NODE_POOL
+            node_pool_trim();
+#endif
+            unsigned long long section = histogram_time_ns() - section_start;
+
+            if(inserts_n > 0) {
+                histogram_record(&op_latency[OP_INSERT], section);
+            }
+            if(deletes_n > 0) {
+                histogram_record(&op_latency[OP_DELETE], section);
+            }
         }
+        counts[OP_MEMBER] += members_n;
+        counts[OP_INSERT] += inserts_n;
+        counts[OP_DELETE] += deletes_n;
+
+        if(set->quiescent != NULL) {
+            set->quiescent();
+        }
+
+        histogram_record(latency, histogram_time_ns() - start);
     }
+}
 
-    pthread_mutex_lock(&count_mutex);
-    member_count += my_member_count;
-    insert_count += my_insert_count;
-    delete_count += my_delete_count;
-    pthread_mutex_unlock(&count_mutex);
+void *scan_work(void *unused) {
+    unsigned seed = 2;
+    struct set_iterator_s iterator;
+    int value;
+
+    (void)unused;
+
+    if(set->thread_online != NULL) {
+        set->thread_online();
+    }
+
+    while(!atomic_load_explicit(&scan_stop, memory_order_relaxed)) {
+        int lo = my_rand(&seed) % MAX_KEY;
+        unsigned long long start = histogram_time_ns();
+
+        if(!set->synchronized && rwlock_rdlock(&rwlock) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        if(set->iterate(lo, lo + scan_width, &iterator) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        if(!set->synchronized && rwlock_unlock(&rwlock) != 0) {
+            exit(EXIT_FAILURE);
+        }
+
+        // The analytics work, while the other threads keep modifying the set
+        while(set_iterator_next(&iterator, &value)) {
+            scanned_keys++;
+        }
+        set_iterator_destroy(&iterator);
+
+        histogram_record(&scan_latency, histogram_time_ns() - start);
+        scan_count++;
+
+        if(set->quiescent != NULL) {
+            set->quiescent();
+        }
+    }
+
+    if(set->thread_offline != NULL) {
+        set->thread_offline();
+    }
 
     return NULL;
 }
 
 int arg_parser(int argc, char *argv[], int *inserts_in_main_p) {
-    if(argc < 13) {
+    int replay = 0;
+
+    for(int i = 1; i < argc; i++) {
+        replay |= strcmp(argv[i], "-R") == 0;
+    }
+
+    // A replayed trace replaces the arguments of the operations
+    if(argc < 13 && !replay) {
         fprintf(
             stderr,
             "usage: %s "
@@ -175,7 +760,20 @@ int arg_parser(int argc, char *argv[], int *inserts_in_main_p) {
             "-o <total_ops> "
             "-s <search_percent> "
             "-i <insert_percent> "
-            "-d <delete_percent>\n",
+            "-d <delete_percent> "
+            "[-l <rwlock>] "
+            "[-S <set>] "
+            "[-a] "
+            "[-u] "
+            "[-b <batch_size>] "
+            "[-D <distribution>] "
+            "[-P <phases>] "
+            "[-r] "
+            "[-n <shards>] "
+            "[-R <trace>] "
+            "[-w <trace>] "
+            "[-x <scan_width>] "
+            "[-f]\n",
             argv[0]
         );
         return 1;
@@ -220,6 +818,67 @@ int arg_parser(int argc, char *argv[], int *inserts_in_main_p) {
                 delete_percent = atof(*(++argv));
                 argc--;
                 break;
+            // The rwlock implementation
+            case 'l':
+                lock_name = *(++argv);
+                argc--;
+                break;
+            // The set implementation
+            case 'S':
+                set_name = *(++argv);
+                argc--;
+                break;
+            // Every combination of rwlock and set implementations
+            case 'a':
+                sweep = 1;
+                break;
+            // Search in upgradeable mode
+            case 'u':
+                upgradeable = 1;
+                break;
+            // Operations per batch
+            case 'b':
+                batch_size = atoi(*(++argv));
+                argc--;
+                break;
+            // The key distribution
+            case 'D':
+                distribution = *(++argv);
+                argc--;
+                break;
+            // The phases
+            case 'P':
+                phases = *(++argv);
+                argc--;
+                break;
+            // Per-thread key ranges
+            case 'r':
+                partitioned = 1;
+                break;
+            // Shards of the sharded sets
+            case 'n':
+                shard_count = atoi(*(++argv));
+                argc--;
+                break;
+            // The trace to replay
+            case 'R':
+                trace_in = *(++argv);
+                argc--;
+                break;
+            // The trace to write
+            case 'w':
+                trace_out = *(++argv);
+                argc--;
+                break;
+            // The width of the ranges of the analytics thread
+            case 'x':
+                scan_width = atoi(*(++argv));
+                argc--;
+                break;
+            // Per-thread search fingers
+            case 'f':
+                fingers = 1;
+                break;
             // Illegal option
             default:
                 return 1;
@@ -229,5 +888,27 @@ int arg_parser(int argc, char *argv[], int *inserts_in_main_p) {
         }
     }
 
+    if(batch_size < 1) {
+        fprintf(stderr, "The batch size must be at least 1\n");
+        return 1;
+    }
+    if(scan_width < 0 || scan_width > MAX_KEY) {
+        fprintf(stderr, "The scan width must be between 0 and %d\n", MAX_KEY);
+        return 1;
+    }
+
+    workload_init(
+        &workload, MAX_KEY, search_percent, insert_percent, delete_percent
+    );
+    workload.partitioned = partitioned;
+    if(workload_parse_distribution(&workload, distribution)) {
+        fprintf(stderr, "Unknown key distribution: %s\n", distribution);
+        return 1;
+    }
+    if(phases != NULL && workload_parse_phases(&workload, phases)) {
+        fprintf(stderr, "Invalid phases: %s\n", phases);
+        return 1;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "node_pool.h"
+#include "timer.h"
+
+/* Free nodes are linked through their first word */
+struct free_node_s {
+    struct free_node_s *next;
+};
+
+/* Slabs are linked through their header, the nodes follow the header */
+struct slab_s {
+    struct slab_s *next;
+};
+
+#define SLAB_HEADER sizeof(max_align_t)
+
+/* A chain of free nodes kept by the depot */
+struct batch_s {
+    struct free_node_s *head;
+    int count;
+};
+
+/* The per-thread cache of free nodes */
+struct magazine_s {
+    struct free_node_s *head;
+    int count;
+
+    /* Counters, merged into the depot by node_pool_thread_exit() */
+    long allocs;
+    long frees;
+    long refills_in_cs;
+    long refills_out_cs;
+    long flushes_in_cs;
+    long flushes_out_cs;
+    double time_in_cs;
+    double time_out_cs;
+};
+
+/* The global store of free nodes */
+struct depot_s {
+    pthread_mutex_t mutex;
+    size_t node_size;
+
+    struct batch_s *batches;
+    int batch_count;
+    int batch_capacity;
+
+    struct slab_s *slabs;
+    long slab_count;
+    char *carve_ptr;
+    int carve_left;
+
+    /* Counters of the threads that have exited */
+    struct magazine_s totals;
+};
+
+static __thread struct magazine_s magazine;
+
+static struct depot_s depot = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+int node_pool_init(size_t size) {
+    pthread_mutex_lock(&depot.mutex);
+
+    if(depot.node_size == 0) {
+        if(size < sizeof(struct free_node_s)) {
+            size = sizeof(struct free_node_s);
+        }
+        // Keep the nodes pointer aligned
+        depot.node_size =
+            (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+    }
+
+    pthread_mutex_unlock(&depot.mutex);
+
+    return 0;
+}
+
+/*
+ * Move a batch of free nodes from the depot to the magazine of the calling
+ * thread. New nodes are carved from a slab if the depot is empty.
+ *
+ * Returns:
+ * - 0 if the magazine was refilled.
+ * - 1 if an error occurred.
+ */
+int _depot_refill(void) {
+    struct batch_s batch = {NULL, 0};
+
+    pthread_mutex_lock(&depot.mutex);
+
+    if(depot.batch_count > 0) {
+        batch = depot.batches[--depot.batch_count];
+    } else {
+        if(depot.carve_left == 0) {
+            struct slab_s *slab =
+                malloc(SLAB_HEADER + NODE_POOL_SLAB_NODES * depot.node_size);
+            if(slab == NULL) {
+                pthread_mutex_unlock(&depot.mutex);
+                return 1;
+            }
+
+            slab->next = depot.slabs;
+            depot.slabs = slab;
+            depot.slab_count++;
+            depot.carve_ptr = (char *)slab + SLAB_HEADER;
+            depot.carve_left = NODE_POOL_SLAB_NODES;
+        }
+
+        while(batch.count < NODE_POOL_BATCH && depot.carve_left > 0) {
+            struct free_node_s *node = (struct free_node_s *)depot.carve_ptr;
+            node->next = batch.head;
+            batch.head = node;
+            batch.count++;
+
+            depot.carve_ptr += depot.node_size;
+            depot.carve_left--;
+        }
+    }
+
+    pthread_mutex_unlock(&depot.mutex);
+
+    // The magazine is empty whenever it gets refilled
+    magazine.head = batch.head;
+    magazine.count = batch.count;
+
+    return 0;
+}
+
+/*
+ * Move a chain of free nodes from the magazine of the calling thread to the
+ * depot.
+ *
+ * Parameters:
+ * - count: the number of nodes to move.
+ */
+void _depot_flush(int count) {
+    struct batch_s batch = {magazine.head, count};
+    struct free_node_s *last = magazine.head;
+
+    // Detach the chain outside of the depot lock
+    for(int i = 1; i < count; i++) {
+        last = last->next;
+    }
+    magazine.head = last->next;
+    magazine.count -= count;
+    last->next = NULL;
+
+    pthread_mutex_lock(&depot.mutex);
+
+    if(depot.batch_count == depot.batch_capacity) {
+        int capacity = depot.batch_capacity ? 2 * depot.batch_capacity : 64;
+        struct batch_s *batches =
+            realloc(depot.batches, capacity * sizeof(struct batch_s));
+        if(batches == NULL) {
+            // Keep the nodes in the magazine rather than losing them
+            pthread_mutex_unlock(&depot.mutex);
+            last->next = magazine.head;
+            magazine.head = batch.head;
+            magazine.count += count;
+            return;
+        }
+        depot.batches = batches;
+        depot.batch_capacity = capacity;
+    }
+    depot.batches[depot.batch_count++] = batch;
+
+    pthread_mutex_unlock(&depot.mutex);
+}
+
+void *node_pool_alloc(void) {
+    if(magazine.head == NULL) {
+        double start, finish;
+
+        GET_TIME(start);
+        int ret = _depot_refill();
+        GET_TIME(finish);
+
+        magazine.refills_in_cs++;
+        magazine.time_in_cs += finish - start;
+
+        if(ret != 0) {
+            return NULL;
+        }
+    }
+
+    struct free_node_s *node = magazine.head;
+    magazine.head = node->next;
+    magazine.count--;
+    magazine.allocs++;
+
+    return node;
+}
+
+void node_pool_free(void *node) {
+    ((struct free_node_s *)node)->next = magazine.head;
+    magazine.head = node;
+    magazine.count++;
+    magazine.frees++;
+
+    // Only flush inside the critical section if trimming was skipped
+    if(magazine.count >= 4 * NODE_POOL_BATCH) {
+        double start, finish;
+
+        GET_TIME(start);
+        _depot_flush(NODE_POOL_BATCH);
+        GET_TIME(finish);
+
+        magazine.flushes_in_cs++;
+        magazine.time_in_cs += finish - start;
+    }
+}
+
+void node_pool_reserve(void) {
+    if(depot.node_size == 0 || magazine.head != NULL) {
+        return;
+    }
+
+    double start, finish;
+
+    GET_TIME(start);
+    _depot_refill();
+    GET_TIME(finish);
+
+    magazine.refills_out_cs++;
+    magazine.time_out_cs += finish - start;
+}
+
+void node_pool_trim(void) {
+    if(magazine.count <= 2 * NODE_POOL_BATCH) {
+        return;
+    }
+
+    double start, finish;
+
+    GET_TIME(start);
+    while(magazine.count > 2 * NODE_POOL_BATCH) {
+        _depot_flush(NODE_POOL_BATCH);
+        magazine.flushes_out_cs++;
+    }
+    GET_TIME(finish);
+
+    magazine.time_out_cs += finish - start;
+}
+
+/*
+ * Add the counters of a magazine to the totals of the depot. The depot lock
+ * should be held.
+ *
+ * Parameters:
+ * - counters: the magazine holding the counters.
+ */
+void _depot_merge_counters(const struct magazine_s *const counters) {
+    depot.totals.allocs += counters->allocs;
+    depot.totals.frees += counters->frees;
+    depot.totals.refills_in_cs += counters->refills_in_cs;
+    depot.totals.refills_out_cs += counters->refills_out_cs;
+    depot.totals.flushes_in_cs += counters->flushes_in_cs;
+    depot.totals.flushes_out_cs += counters->flushes_out_cs;
+    depot.totals.time_in_cs += counters->time_in_cs;
+    depot.totals.time_out_cs += counters->time_out_cs;
+}
+
+void node_pool_thread_exit(void) {
+    if(magazine.count > 0) {
+        _depot_flush(magazine.count);
+    }
+
+    pthread_mutex_lock(&depot.mutex);
+    _depot_merge_counters(&magazine);
+    pthread_mutex_unlock(&depot.mutex);
+
+    magazine = (struct magazine_s){0};
+}
+
+void node_pool_destroy(void) {
+    pthread_mutex_lock(&depot.mutex);
+
+    _depot_merge_counters(&magazine);
+    magazine = (struct magazine_s){0};
+
+    struct slab_s *slab = depot.slabs;
+    while(slab != NULL) {
+        struct slab_s *following = slab->next;
+        free(slab);
+        slab = following;
+    }
+
+    free(depot.batches);
+
+    depot.batches = NULL;
+    depot.batch_count = 0;
+    depot.batch_capacity = 0;
+    depot.slabs = NULL;
+    depot.carve_ptr = NULL;
+    depot.carve_left = 0;
+
+    pthread_mutex_unlock(&depot.mutex);
+}
+
+void node_pool_print_stats(void) {
+    pthread_mutex_lock(&depot.mutex);
+
+    printf("Node pool allocs = %ld\n", depot.totals.allocs);
+    printf("Node pool frees = %ld\n", depot.totals.frees);
+    printf("Node pool slabs = %ld\n", depot.slab_count);
+    printf(
+        "Node pool depot transfers in critical sections = %ld (%lf seconds)\n",
+        depot.totals.refills_in_cs + depot.totals.flushes_in_cs,
+        depot.totals.time_in_cs
+    );
+    printf(
+        "Node pool depot transfers moved out of critical sections = %ld (%lf "
+        "seconds)\n",
+        depot.totals.refills_out_cs + depot.totals.flushes_out_cs,
+        depot.totals.time_out_cs
+    );
+
+    pthread_mutex_unlock(&depot.mutex);
+}
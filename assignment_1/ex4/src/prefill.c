@@ -0,0 +1,168 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "my_rand.h"
+#include "prefill.h"
+#include "set.h"
+
+/* A range of keys sorted by a thread */
+struct chunk_s {
+    int *keys;
+    int count;
+};
+
+static void *_sort_chunk(void *chunk_p) {
+    struct chunk_s *chunk = chunk_p;
+
+    qsort(chunk->keys, chunk->count, sizeof(int), set_compare_keys);
+
+    return NULL;
+}
+
+/*
+ * Sort keys, splitting them in chunks that are sorted by different threads
+ * and then merged pairwise.
+ *
+ * Parameters:
+ * - keys: the keys to be sorted.
+ * - count: the number of keys.
+ * - threads: the largest number of threads.
+ *
+ * Returns:
+ * - 0 if the keys were sorted successfully.
+ * - 1 if an error occurred.
+ */
+static int _parallel_sort(int *keys, int count, int threads) {
+    if(threads > count / PREFILL_MIN_CHUNK) {
+        threads = count / PREFILL_MIN_CHUNK;
+    }
+    if(threads <= 1) {
+        qsort(keys, count, sizeof(int), set_compare_keys);
+        return 0;
+    }
+
+    struct chunk_s *chunks = malloc(threads * sizeof(struct chunk_s));
+    pthread_t *handles = malloc(threads * sizeof(pthread_t));
+    int *buffer = malloc(count * sizeof(int));
+    /* The bounds of the sorted runs, run i is [bounds[i], bounds[i + 1]) */
+    int *bounds = malloc((threads + 1) * sizeof(int));
+
+    if(chunks == NULL || handles == NULL || buffer == NULL || bounds == NULL) {
+        free(chunks);
+        free(handles);
+        free(buffer);
+        free(bounds);
+        return 1;
+    }
+
+    for(int i = 0; i <= threads; i++) {
+        bounds[i] = (int)((long long)count * i / threads);
+    }
+    for(int i = 0; i < threads; i++) {
+        chunks[i].keys = keys + bounds[i];
+        chunks[i].count = bounds[i + 1] - bounds[i];
+        pthread_create(&handles[i], NULL, _sort_chunk, &chunks[i]);
+    }
+    for(int i = 0; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+    }
+
+    // Merge pairs of adjacent runs until a single run is left
+    int *from = keys, *to = buffer;
+    int runs = threads;
+
+    while(runs > 1) {
+        int merged = 0;
+
+        for(int i = 0; i < runs; i += 2) {
+            int a = bounds[i], a_end = bounds[i + 1];
+            int b = a_end, b_end = i + 1 < runs ? bounds[i + 2] : a_end;
+            int out = bounds[i];
+
+            while(a < a_end && b < b_end) {
+                to[out++] = from[a] <= from[b] ? from[a++] : from[b++];
+            }
+            memcpy(&to[out], &from[a], (a_end - a) * sizeof(int));
+            out += a_end - a;
+            memcpy(&to[out], &from[b], (b_end - b) * sizeof(int));
+
+            bounds[merged++] = bounds[i];
+        }
+        bounds[merged] = count;
+        runs = merged;
+
+        int *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if(from != keys) {
+        memcpy(keys, from, count * sizeof(int));
+    }
+
+    free(chunks);
+    free(handles);
+    free(buffer);
+    free(bounds);
+
+    return 0;
+}
+
+int prefill_generate(
+    int count, int max_key, unsigned seed, int threads, int **keys_p,
+    int *count_p
+) {
+    *keys_p = NULL;
+    *count_p = 0;
+    if(count <= 0) {
+        return 0;
+    }
+
+    // Open addressing set of the keys drawn so far, at most half full
+    int bits = 2;
+    while((1u << bits) < 4u * (unsigned)count) {
+        bits++;
+    }
+    unsigned capacity = 1u << bits;
+
+    int *table = malloc(capacity * sizeof(int));
+    int *keys = malloc(count * sizeof(int));
+
+    if(table == NULL || keys == NULL) {
+        free(table);
+        free(keys);
+        return 1;
+    }
+    memset(table, -1, capacity * sizeof(int));
+
+    int found = 0, attempts = 0;
+
+    /* Same loop as inserting one key at a time: stop after count distinct */
+    /* keys or 2*count attempts.                                           */
+    while(found < count && attempts < 2 * count) {
+        int key = my_rand(&seed) % max_key;
+        // Multiplicative hash, the high bits pick the slot
+        unsigned slot = ((unsigned)key * 2654435761u) >> (32 - bits);
+
+        attempts++;
+        while(table[slot] != -1 && table[slot] != key) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if(table[slot] == -1) {
+            table[slot] = key;
+            keys[found++] = key;
+        }
+    }
+    free(table);
+
+    if(_parallel_sort(keys, found, threads) != 0) {
+        free(keys);
+        return 1;
+    }
+
+    *keys_p = keys;
+    *count_p = found;
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "qsbr.h"
+
+/* Size of a cache line in bytes */
+#define CACHE_LINE 64
+
+/* The record of an online thread, filling a whole cache line */
+struct qsbr_thread_s {
+    _Alignas(CACHE_LINE) atomic_ulong quiescent;
+    struct qsbr_thread_s *next;
+};
+
+/* A retired node and the epoch of its retirement */
+struct retired_s {
+    void *ptr;
+    unsigned long epoch;
+};
+
+/* The global state, the mutex protects everything but the epoch */
+struct qsbr_s {
+    _Alignas(CACHE_LINE) atomic_ulong epoch;
+    pthread_mutex_t mutex;
+    struct qsbr_thread_s *threads;
+
+    struct retired_s *retired;
+    int retired_count;
+    int retired_capacity;
+    int next_scan;
+};
+
+static __thread struct qsbr_thread_s self;
+
+static struct qsbr_s qsbr = {
+    .epoch = 1,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .next_scan = QSBR_BATCH,
+};
+
+/*
+ * Free every retired node whose grace period has elapsed. The mutex should be
+ * held.
+ */
+static void _scan(void) {
+    unsigned long safe = ULONG_MAX;
+    int kept = 0;
+
+    for(struct qsbr_thread_s *t = qsbr.threads; t != NULL; t = t->next) {
+        unsigned long quiescent =
+            atomic_load_explicit(&t->quiescent, memory_order_acquire);
+        if(quiescent < safe) {
+            safe = quiescent;
+        }
+    }
+
+    for(int i = 0; i < qsbr.retired_count; i++) {
+        if(qsbr.retired[i].epoch <= safe) {
+            free(qsbr.retired[i].ptr);
+        } else {
+            qsbr.retired[kept++] = qsbr.retired[i];
+        }
+    }
+
+    qsbr.retired_count = kept;
+    qsbr.next_scan = kept + QSBR_BATCH;
+}
+
+void qsbr_thread_online(void) {
+    pthread_mutex_lock(&qsbr.mutex);
+
+    atomic_store(&self.quiescent, atomic_load(&qsbr.epoch));
+    self.next = qsbr.threads;
+    qsbr.threads = &self;
+
+    pthread_mutex_unlock(&qsbr.mutex);
+}
+
+void qsbr_quiescent(void) {
+    // The release store orders every read of the last operation before the
+    // announcement
+    atomic_store_explicit(
+        &self.quiescent,
+        atomic_load_explicit(&qsbr.epoch, memory_order_acquire),
+        memory_order_release
+    );
+}
+
+void qsbr_thread_offline(void) {
+    pthread_mutex_lock(&qsbr.mutex);
+
+    struct qsbr_thread_s **t = &qsbr.threads;
+    while(*t != &self) {
+        t = &(*t)->next;
+    }
+    *t = self.next;
+    self.next = NULL;
+
+    // The last thread to leave frees every retired node
+    _scan();
+
+    pthread_mutex_unlock(&qsbr.mutex);
+}
+
+void qsbr_retire(void *ptr) {
+    pthread_mutex_lock(&qsbr.mutex);
+
+    if(qsbr.retired_count == qsbr.retired_capacity) {
+        int capacity = qsbr.retired_capacity ? 2 * qsbr.retired_capacity
+                                             : 2 * QSBR_BATCH;
+        struct retired_s *retired =
+            realloc(qsbr.retired, capacity * sizeof(struct retired_s));
+        if(retired == NULL) {
+            // Leak the node rather than free it under a reader
+            pthread_mutex_unlock(&qsbr.mutex);
+            return;
+        }
+        qsbr.retired = retired;
+        qsbr.retired_capacity = capacity;
+    }
+
+    // The node was unlinked before the epoch moves, a thread that records
+    // the new epoch can no longer reach it
+    unsigned long epoch = atomic_fetch_add(&qsbr.epoch, 1) + 1;
+
+    qsbr.retired[qsbr.retired_count].ptr = ptr;
+    qsbr.retired[qsbr.retired_count].epoch = epoch;
+    qsbr.retired_count++;
+
+    if(qsbr.retired_count >= qsbr.next_scan) {
+        _scan();
+    }
+
+    pthread_mutex_unlock(&qsbr.mutex);
+}
+
+void qsbr_reclaim(void) {
+    pthread_mutex_lock(&qsbr.mutex);
+    _scan();
+    pthread_mutex_unlock(&qsbr.mutex);
+}
@@ -0,0 +1,375 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qsbr.h"
+#include "set.h"
+
+/*
+ * Struct for list nodes. The next pointer is atomic, because readers follow
+ * it while a writer may be redirecting it.
+ */
+struct list_node_s {
+    int data;
+    struct list_node_s *_Atomic next;
+};
+
+/* The head of the list */
+static struct list_node_s *_Atomic head = NULL;
+
+/* Serializes the writers, readers never take it */
+static pthread_mutex_t mutex_w = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Odd while a writer changes the list, incremented before and after every
+ * change. A range scan that read the same even value before and after its
+ * walk saw the list at a single point in time.
+ */
+static atomic_uint seqcount = 0;
+
+/* Lock-free walks of a range scan before it takes the writer mutex */
+#define SCAN_ATTEMPTS 4
+
+/* Searches start from the finger of the thread when they can */
+static int use_fingers = 0;
+
+/*
+ * Incremented after every node is unlinked and before it is retired,
+ * invalidating the fingers. A walk that loaded the epoch before it started
+ * cannot reach a node that was unlinked before a later epoch.
+ */
+static atomic_ulong delete_epoch = 0;
+
+/*
+ * The finger of the thread: the last node that a search of the thread went
+ * past, still in the list as long as the delete epoch has not changed. The
+ * node cannot be freed before the epoch changes and the thread announces a
+ * quiescent state, so checking the epoch is enough to dereference it.
+ */
+static __thread struct {
+    struct list_node_s *node;
+    unsigned long delete_epoch;
+} finger;
+
+/*
+ * Get the node a search can start after.
+ *
+ * Parameters:
+ * - value: the value to be searched.
+ * - epoch: the delete epoch, loaded before the search.
+ *
+ * Returns:
+ * - the finger of the thread, if it is still in the list and smaller than
+ * the value.
+ * - NULL if the search starts from the head.
+ */
+static struct list_node_s *_finger_start(int value, unsigned long epoch) {
+    if(use_fingers && finger.node != NULL && finger.delete_epoch == epoch &&
+       finger.node->data < value) {
+        return finger.node;
+    }
+
+    return NULL;
+}
+
+/*
+ * Remember the last node a search went past as the finger of the thread.
+ *
+ * Parameters:
+ * - pred: the last node smaller than the searched value, NULL for none.
+ * - epoch: the delete epoch, loaded before the search.
+ */
+static void _finger_end(struct list_node_s *pred, unsigned long epoch) {
+    if(use_fingers && pred != NULL) {
+        finger.node = pred;
+        finger.delete_epoch = epoch;
+    }
+}
+
+/*
+ * Announce that the list is about to change. The writer mutex should be held.
+ */
+static void _write_begin(void) {
+    atomic_fetch_add_explicit(&seqcount, 1, memory_order_relaxed);
+    // The change is not visible before the odd count
+    atomic_thread_fence(memory_order_release);
+}
+
+/*
+ * Announce that the list has changed. The writer mutex should be held.
+ */
+static void _write_end(void) {
+    atomic_fetch_add_explicit(&seqcount, 1, memory_order_release);
+}
+
+/*
+ * Find the first node whose value is not smaller than a value. The writer
+ * mutex should be held.
+ *
+ * Parameters:
+ * - value: the value to be searched.
+ * - link_p: set to the link that points to the returned node.
+ *
+ * Returns:
+ * - the first node whose value is not smaller than the value.
+ * - NULL if the value is larger than every value of the list.
+ */
+static struct list_node_s *
+_find(int value, struct list_node_s *_Atomic **link_p) {
+    unsigned long epoch =
+        atomic_load_explicit(&delete_epoch, memory_order_relaxed);
+    struct list_node_s *pred = _finger_start(value, epoch);
+    struct list_node_s *_Atomic *link = pred != NULL ? &pred->next : &head;
+    struct list_node_s *curr =
+        atomic_load_explicit(link, memory_order_relaxed);
+
+    while(curr != NULL && curr->data < value) {
+        pred = curr;
+        link = &curr->next;
+        curr = atomic_load_explicit(link, memory_order_relaxed);
+    }
+
+    _finger_end(pred, epoch);
+    *link_p = link;
+
+    return curr;
+}
+
+static int _insert(int value) {
+    struct list_node_s *_Atomic *link;
+    struct list_node_s *curr;
+    struct list_node_s *temp;
+    int rv = 1;
+
+    pthread_mutex_lock(&mutex_w);
+
+    curr = _find(value, &link);
+    if(curr == NULL || curr->data > value) {
+        if((temp = malloc(sizeof(struct list_node_s))) == NULL) {
+            pthread_mutex_unlock(&mutex_w);
+            return 0;
+        }
+        temp->data = value;
+        atomic_init(&temp->next, curr);
+        // Publish the node only once it is fully initialized
+        _write_begin();
+        atomic_store_explicit(link, temp, memory_order_release);
+        _write_end();
+    } else { /* value in list */
+        rv = 0;
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+
+    return rv;
+}
+
+static void _print(void) {
+    struct list_node_s *temp;
+
+    printf("list = ");
+
+    temp = atomic_load(&head);
+    while(temp != (struct list_node_s *)NULL) {
+        printf("%d ", temp->data);
+        temp = atomic_load(&temp->next);
+    }
+    printf("\n");
+}
+
+static int _member(int value) {
+    unsigned long epoch =
+        atomic_load_explicit(&delete_epoch, memory_order_acquire);
+    struct list_node_s *pred = _finger_start(value, epoch);
+    struct list_node_s *temp;
+
+    // Only loads, a node unlinked during the walk stays valid until the
+    // calling thread announces its next quiescent state
+    temp = atomic_load_explicit(
+        pred != NULL ? &pred->next : &head, memory_order_acquire
+    );
+    while(temp != NULL && temp->data < value) {
+        pred = temp;
+        temp = atomic_load_explicit(&temp->next, memory_order_acquire);
+    }
+    _finger_end(pred, epoch);
+
+    if(temp == NULL || temp->data > value) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+static int _delete(int value) {
+    struct list_node_s *_Atomic *link;
+    struct list_node_s *curr;
+    int rv = 1;
+
+    pthread_mutex_lock(&mutex_w);
+
+    curr = _find(value, &link);
+    if(curr != NULL && curr->data == value) {
+        // Readers on the node still find the rest of the list through it
+        _write_begin();
+        atomic_store_explicit(
+            link, atomic_load_explicit(&curr->next, memory_order_relaxed),
+            memory_order_release
+        );
+        _write_end();
+        atomic_fetch_add_explicit(&delete_epoch, 1, memory_order_release);
+        qsbr_retire(curr);
+    } else { /* Not in list */
+        rv = 0;
+    }
+
+    pthread_mutex_unlock(&mutex_w);
+
+    return rv;
+}
+
+/*
+ * Link the nodes of the values from the largest one, then publish the whole
+ * chain with a single store of the head.
+ */
+static void _bulk_load(const int *values, int count) {
+    struct list_node_s *chain = NULL;
+    struct list_node_s *temp;
+
+    pthread_mutex_lock(&mutex_w);
+
+    for(int i = count - 1; i >= 0; i--) {
+        if((temp = malloc(sizeof(struct list_node_s))) == NULL) {
+            break;
+        }
+        temp->data = values[i];
+        atomic_init(&temp->next, chain);
+        chain = temp;
+    }
+    _write_begin();
+    atomic_store_explicit(&head, chain, memory_order_release);
+    _write_end();
+
+    pthread_mutex_unlock(&mutex_w);
+}
+
+/*
+ * Walk the values of [lo, hi), counting them and, if an iterator is given,
+ * appending them to it.
+ *
+ * Parameters:
+ * - lo: the smallest value of the range.
+ * - hi: the value after the largest value of the range.
+ * - iterator: the iterator, NULL to only count.
+ *
+ * Returns:
+ * - the number of values of the range.
+ * - -1 if the values could not be appended.
+ */
+static int _walk_range(int lo, int hi, struct set_iterator_s *iterator) {
+    struct list_node_s *temp;
+    int count = 0;
+
+    temp = atomic_load_explicit(&head, memory_order_acquire);
+    while(temp != NULL && temp->data < lo)
+        temp = atomic_load_explicit(&temp->next, memory_order_acquire);
+    while(temp != NULL && temp->data < hi) {
+        if(iterator != NULL && set_iterator_append(iterator, temp->data)) {
+            return -1;
+        }
+        count++;
+        temp = atomic_load_explicit(&temp->next, memory_order_acquire);
+    }
+
+    return count;
+}
+
+/*
+ * Walk a range without locks until no writer changed the list during the
+ * walk. After SCAN_ATTEMPTS walks that raced with writers, the walk holds
+ * the writer mutex instead, so a scan cannot starve.
+ */
+static int _scan_range(int lo, int hi, struct set_iterator_s *iterator) {
+    int count;
+
+    for(int attempt = 0; attempt < SCAN_ATTEMPTS; attempt++) {
+        unsigned begin =
+            atomic_load_explicit(&seqcount, memory_order_acquire);
+
+        if(begin & 1) {
+            continue;
+        }
+        if(iterator != NULL) {
+            iterator->count = 0;
+        }
+        count = _walk_range(lo, hi, iterator);
+        // The walk is done before the count is read again
+        atomic_thread_fence(memory_order_acquire);
+        if(count < 0 ||
+           atomic_load_explicit(&seqcount, memory_order_relaxed) == begin) {
+            return count;
+        }
+    }
+
+    pthread_mutex_lock(&mutex_w);
+    if(iterator != NULL) {
+        iterator->count = 0;
+    }
+    count = _walk_range(lo, hi, iterator);
+    pthread_mutex_unlock(&mutex_w);
+
+    return count;
+}
+
+static int _range_count(int lo, int hi) { return _scan_range(lo, hi, NULL); }
+
+static int _iterate(int lo, int hi, struct set_iterator_s *iterator) {
+    set_iterator_init(iterator);
+    if(_scan_range(lo, hi, iterator) < 0) {
+        set_iterator_destroy(iterator);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void _free_list(void) {
+    struct list_node_s *current = atomic_load(&head);
+    struct list_node_s *following;
+
+    while(current != NULL) {
+        following = atomic_load(&current->next);
+        free(current);
+        current = following;
+    }
+
+    atomic_store(&head, NULL);
+    atomic_fetch_add(&delete_epoch, 1);
+
+    // No thread is online anymore, every retired node can go
+    qsbr_reclaim();
+}
+
+static int _init(const struct set_params_s *params) {
+    use_fingers = params->fingers;
+
+    return 0;
+}
+
+const struct set_ops_s rcu_set_ops = {
+    .name = "rcu",
+    .synchronized = 1,
+    .init = _init,
+    .insert = _insert,
+    .print = _print,
+    .member = _member,
+    .delete = _delete,
+    .free_list = _free_list,
+    .bulk_load = _bulk_load,
+    .range_count = _range_count,
+    .iterate = _iterate,
+    .thread_online = qsbr_thread_online,
+    .quiescent = qsbr_quiescent,
+    .thread_offline = qsbr_thread_offline,
+};
@@ -0,0 +1,669 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rwlock_impl.h"
+#ifdef RWLOCK_STATS
+#include "histogram.h"
+#include "rwlock_stats.h"
+#endif
+
+/*
+ * Rwlock built on a mutex and two condition variables. The policy decides
+ * which waiting threads are admitted and which ones are signaled.
+ */
+typedef struct {
+    pthread_cond_t cond_read;
+    pthread_cond_t cond_write;
+    pthread_cond_t cond_upgrade;
+    pthread_mutex_t mutex_rw;
+    int policy;
+    unsigned int executing_readers;
+    unsigned int waiting_readers;
+    unsigned int executing_writers;
+    unsigned int waiting_writers;
+    pthread_t writer;
+    // Incremented by every writer that unlocks and admits the waiting readers
+    // (phase-fair policy)
+    unsigned long reader_phase;
+    // Readers admitted by the last reader phase that have not entered yet
+    // (phase-fair policy)
+    unsigned int admitted_readers;
+    // A reader holds the rwlock in upgradeable mode, it is counted in the
+    // executing readers
+    int upgradeable_held;
+    pthread_t upgrader;
+    // Waiting readers that want the upgradeable mode, they are not part of
+    // the reader phases
+    unsigned int waiting_upgradeable;
+    // The upgradeable reader waits for the other readers to drain
+    int upgrading;
+#ifdef RWLOCK_STATS
+    struct rwlock_stats_s *stats;
+#endif
+} cond_rwlock_s;
+
+static int _init(void **lock_p, int policy) {
+    cond_rwlock_s *lock = malloc(sizeof(cond_rwlock_s));
+
+    if((*lock_p = lock) == NULL) {
+        return 1;
+    };
+
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    if(rwlock_stats_init(&lock->stats) != 0) {
+        return 1;
+    };
+#endif
+
+    if((ret = pthread_cond_init(&lock->cond_read, NULL)) != 0) {
+        return ret;
+    };
+
+    if((ret = pthread_cond_init(&lock->cond_write, NULL)) != 0) {
+        return ret;
+    };
+
+    if((ret = pthread_cond_init(&lock->cond_upgrade, NULL)) != 0) {
+        return ret;
+    };
+
+    if((ret = pthread_mutex_init(&lock->mutex_rw, NULL)) != 0) {
+        return ret;
+    };
+
+    lock->policy = policy;
+    lock->executing_readers = 0;
+    lock->waiting_readers = 0;
+    lock->executing_writers = 0;
+    lock->waiting_writers = 0;
+    lock->writer = 0;
+    lock->reader_phase = 0;
+    lock->admitted_readers = 0;
+    lock->upgradeable_held = 0;
+    lock->upgrader = 0;
+    lock->waiting_upgradeable = 0;
+    lock->upgrading = 0;
+
+    return 0;
+}
+
+/*
+ * The predicate that determines if the rwlock can be acquired for reading.
+ *
+ * Parameters:
+ * - lock: the rwlock to be checked.
+ *
+ * Returns:
+ * - 1 if the rwlock can be acquired for reading.
+ * - 0 if the rwlock cannot be acquired for reading.
+ */
+static int _rd_predicate(const cond_rwlock_s *const lock) {
+    int predicate;
+
+    switch(lock->policy) {
+    case RWLOCK_READER_PRIORITY:
+        // There is no executing writer
+        predicate = (lock->executing_writers == 0);
+        break;
+    default:
+        // There is no executing writer and no waiting writer
+        predicate =
+            ((lock->executing_writers == 0) && (lock->waiting_writers == 0));
+        break;
+    }
+
+    return predicate;
+}
+
+/*
+ * Acquire the rwlock for reading, optionally in upgradeable mode.
+ *
+ * Parameters:
+ * - lock: the rwlock to be locked.
+ * - upgradeable: 1 to lock in upgradeable mode, 0 otherwise.
+ *
+ * Returns:
+ * - 0 if the rwlock was locked successfully.
+ * - non-zero value if an error occurred.
+ */
+static int _rd_acquire(cond_rwlock_s *lock, int upgradeable) {
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int wakeups = 0;
+#endif
+
+    if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+    // With the phase-fair policy, a reader that has to wait joins the next
+    // reader phase, which starts when the executing or waiting writer unlocks.
+    // An upgradeable reader could become a writer inside the phase, so it
+    // always waits for the predicate.
+    unsigned long phase = lock->reader_phase;
+
+#ifdef DEBUG
+    static int calls = 0;
+
+    printf("============================================\n");
+    printf("RD_LOCK: (%d calls)\n", calls);
+    printf("- Executing readers: %d\n", lock->executing_readers);
+    printf("- Waiting readers: %d\n", lock->waiting_readers);
+    printf("- Executing writers: %d\n", lock->executing_writers);
+    printf("- Waiting writers: %d\n", lock->waiting_writers);
+    printf("- Writer: %ld\n", lock->writer);
+    fflush(stdout);
+#endif
+
+    // New readers also wait for an upgrade to complete, and an upgradeable
+    // reader for the current one to unlock
+    while(!_rd_predicate(lock) || lock->upgrading ||
+          (upgradeable && lock->upgradeable_held) || (ret != 0)) {
+        if(lock->policy == RWLOCK_PHASE_FAIR && phase != lock->reader_phase &&
+           !upgradeable) {
+            break;
+        }
+        lock->waiting_readers++;
+        lock->waiting_upgradeable += upgradeable;
+        ret = pthread_cond_wait(&lock->cond_read, &lock->mutex_rw);
+        lock->waiting_upgradeable -= upgradeable;
+        lock->waiting_readers--;
+#ifdef RWLOCK_STATS
+        wakeups++;
+#endif
+    }
+
+    // Only the readers that waited through a phase change were admitted
+    if(lock->policy == RWLOCK_PHASE_FAIR && phase != lock->reader_phase &&
+       !upgradeable) {
+        lock->admitted_readers--;
+    }
+
+    lock->executing_readers++;
+    if(upgradeable) {
+        lock->upgradeable_held = 1;
+        lock->upgrader = pthread_self();
+    }
+
+#ifdef DEBUG
+    calls++;
+
+    printf("--------------------------------------------\n");
+    printf("- Executing readers: %d\n", lock->executing_readers);
+    printf("- Waiting readers: %d\n", lock->waiting_readers);
+    printf("- Executing writers: %d\n", lock->executing_writers);
+    printf("- Waiting writers: %d\n", lock->waiting_writers);
+    printf("- Writer: %ld\n", lock->writer);
+    fflush(stdout);
+#endif
+
+    if((ret = pthread_mutex_unlock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_READ, wait_start, wakeups > 0, wakeups
+    );
+#endif
+
+    return 0;
+}
+
+static int _rdlock(void *lock_p) { return _rd_acquire(lock_p, 0); }
+
+static int _rdlock_upgradeable(void *lock_p) { return _rd_acquire(lock_p, 1); }
+
+static int _upgrade(void *lock_p) {
+    cond_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_released(lock->stats);
+
+    unsigned long long wait_start = histogram_time_ns();
+    int wakeups = 0;
+#endif
+
+    if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+    // No writer can enter while the upgradeable reader executes, so only the
+    // other readers, including the admitted ones of a reader phase, have to
+    // drain
+    lock->upgrading = 1;
+    while(lock->executing_readers > 1 || lock->admitted_readers > 0 ||
+          (ret != 0)) {
+        ret = pthread_cond_wait(&lock->cond_upgrade, &lock->mutex_rw);
+#ifdef RWLOCK_STATS
+        wakeups++;
+#endif
+    }
+    lock->upgrading = 0;
+
+    lock->executing_readers = 0;
+    lock->upgradeable_held = 0;
+    lock->executing_writers = 1;
+    lock->writer = pthread_self();
+
+    if((ret = pthread_mutex_unlock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_WRITE, wait_start, wakeups > 0, wakeups
+    );
+#endif
+
+    return 0;
+}
+
+static int _downgrade(void *lock_p) {
+    cond_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_released(lock->stats);
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_READ, histogram_time_ns(), 0, 0
+    );
+#endif
+
+    if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+    lock->executing_writers = 0;
+    lock->executing_readers++;
+
+    // The waiting readers check the predicate of the policy again
+    if(lock->waiting_readers > 0) {
+        pthread_cond_broadcast(&lock->cond_read);
+    }
+
+    if((ret = pthread_mutex_unlock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+    return 0;
+}
+
+/*
+ * The predicate that determines if the rwlock can be acquired for writing.
+ *
+ * Parameters:
+ * - lock: the rwlock to be checked.
+ *
+ * Returns:
+ * - 1 if the rwlock can be acquired for writing.
+ * - 0 if the rwlock cannot be acquired for writing.
+ */
+static int _rw_predicate(const cond_rwlock_s *const lock) {
+    int predicate;
+
+    switch(lock->policy) {
+    case RWLOCK_READER_PRIORITY:
+        // There is no executing or waiting reader and no executing writer
+        predicate = (lock->executing_readers == 0) &&
+                    (lock->waiting_readers == 0) &&
+                    (lock->executing_writers == 0);
+        break;
+    case RWLOCK_WRITER_PRIORITY:
+        // There is no executing reader and no executing writer
+        predicate =
+            (lock->executing_readers == 0) && (lock->executing_writers == 0);
+        break;
+    default:
+        // There is no executing reader, no admitted reader and no executing
+        // writer
+        predicate = (lock->executing_readers == 0) &&
+                    (lock->admitted_readers == 0) &&
+                    (lock->executing_writers == 0);
+        break;
+    }
+
+    return predicate;
+}
+
+static int _wrlock(void *lock_p) {
+    cond_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int wakeups = 0;
+#endif
+
+    if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef DEBUG
+    static int calls = 0;
+
+    printf("============================================\n");
+    printf("WR_LOCK: (%d calls)\n", calls);
+    printf("- Executing readers: %d\n", lock->executing_readers);
+    printf("- Waiting readers: %d\n", lock->waiting_readers);
+    printf("- Executing writers: %d\n", lock->executing_writers);
+    printf("- Waiting writers: %d\n", lock->waiting_writers);
+    printf("- Writer: %ld\n", lock->writer);
+    fflush(stdout);
+#endif
+
+    while(!_rw_predicate(lock) || (ret != 0)) {
+        lock->waiting_writers++;
+        ret = pthread_cond_wait(&lock->cond_write, &lock->mutex_rw);
+        lock->waiting_writers--;
+#ifdef RWLOCK_STATS
+        wakeups++;
+#endif
+    }
+
+    lock->executing_writers = 1;
+    lock->writer = pthread_self();
+
+#ifdef DEBUG
+    calls++;
+
+    printf("--------------------------------------------\n");
+    printf("- Executing readers: %d\n", lock->executing_readers);
+    printf("- Waiting readers: %d\n", lock->waiting_readers);
+    printf("- Executing writers: %d\n", lock->executing_writers);
+    printf("- Waiting writers: %d\n", lock->waiting_writers);
+    printf("- Writer: %ld\n", lock->writer);
+    fflush(stdout);
+#endif
+
+    if((ret = pthread_mutex_unlock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_WRITE, wait_start, wakeups > 0, wakeups
+    );
+#endif
+
+    return 0;
+}
+
+/*
+ * The predicate that determines if the unlocking writer should signal a waiting
+ * reader.
+ *
+ * Parameters:
+ * - lock: the rwlock to be checked.
+ *
+ * Returns:
+ * - 1 if the unlocking writer should signal a waiting reader.
+ * - 0 if the unlocking writer should not signal a waiting reader.
+ */
+static int _uwr_signal_rd(const cond_rwlock_s *const lock) {
+    int signal_rd;
+
+    switch(lock->policy) {
+    case RWLOCK_WRITER_PRIORITY:
+        signal_rd = (lock->waiting_readers > 0) && (lock->waiting_writers == 0);
+        break;
+    default:
+        // With the phase-fair policy the waiting readers form the next reader
+        // phase
+        signal_rd = (lock->waiting_readers > 0);
+        break;
+    }
+
+    return signal_rd;
+}
+
+/*
+ * The predicate that determines if the unlocking writer should signal a waiting
+ * writer.
+ *
+ * Parameters:
+ * - lock: the rwlock to be checked.
+ *
+ * Returns:
+ * - 1 if the unlocking writer should signal a waiting writer.
+ * - 0 if the unlocking writer should not signal a waiting writer.
+ */
+static int _uwr_signal_wr(const cond_rwlock_s *const lock) {
+    int signal_wr;
+
+    switch(lock->policy) {
+    case RWLOCK_READER_PRIORITY:
+        signal_wr = (lock->waiting_readers == 0) &&
+                    (lock->executing_readers == 0) &&
+                    (lock->waiting_writers > 0);
+        break;
+    case RWLOCK_WRITER_PRIORITY:
+        signal_wr =
+            (lock->executing_readers == 0) && (lock->waiting_writers > 0);
+        break;
+    default:
+        // The next writer phase starts only if no reader phase is due
+        signal_wr = (lock->waiting_readers == 0) && (lock->waiting_writers > 0);
+        break;
+    }
+
+    return signal_wr;
+}
+
+/*
+ * The predicate that determines if the unlocking reader should signal a waiting
+ * reader.
+ *
+ * Parameters:
+ * - lock: the rwlock to be checked.
+ *
+ * Returns:
+ * - 1 if the unlocking reader should signal a waiting reader.
+ * - 0 if the unlocking reader should not signal a waiting reader.
+ */
+static int _urd_signal_rd(const cond_rwlock_s *const lock) {
+    int signal_rd;
+
+    switch(lock->policy) {
+    case RWLOCK_READER_PRIORITY:
+        signal_rd =
+            ((lock->waiting_readers > 0) && (lock->executing_writers == 0));
+        break;
+    default:
+        signal_rd =
+            ((lock->waiting_readers > 0) && (lock->waiting_writers == 0) &&
+             (lock->executing_writers == 0));
+        break;
+    }
+
+    return signal_rd;
+}
+
+/*
+ * The predicate that determines if the unlocking reader should signal a waiting
+ * writer.
+ *
+ * Parameters:
+ * - lock: the rwlock to be checked.
+ *
+ * Returns:
+ * - 1 if the unlocking reader should signal a waiting writer.
+ * - 0 if the unlocking reader should not signal a waiting writer.
+ */
+static int _urd_signal_wr(const cond_rwlock_s *const lock) {
+    int signal_wr;
+
+    switch(lock->policy) {
+    case RWLOCK_READER_PRIORITY:
+        signal_wr = (lock->waiting_readers == 0) &&
+                    (lock->executing_readers == 0) &&
+                    (lock->waiting_writers > 0) &&
+                    (lock->executing_writers == 0);
+        break;
+    case RWLOCK_WRITER_PRIORITY:
+        signal_wr = (lock->executing_readers == 0) &&
+                    (lock->waiting_writers > 0) &&
+                    (lock->executing_writers == 0);
+        break;
+    default:
+        signal_wr = (lock->executing_readers == 0) &&
+                    (lock->admitted_readers == 0) &&
+                    (lock->waiting_writers > 0) &&
+                    (lock->executing_writers == 0);
+        break;
+    }
+
+    return signal_wr;
+}
+
+static int _unlock(void *lock_p) {
+    cond_rwlock_s *lock = lock_p;
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_released(lock->stats);
+#endif
+
+    int ret = 0;
+
+    if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef DEBUG
+    static int calls_writer = 0;
+    static int calls_reader = 0;
+
+    printf("============================================\n");
+    printf(
+        "UNLOCK: (%d calls_writer, %d calls_reader)\n", calls_writer,
+        calls_reader
+    );
+    printf("- Executing readers: %d\n", lock->executing_readers);
+    printf("- Waiting readers: %d\n", lock->waiting_readers);
+    printf("- Executing writers: %d\n", lock->executing_writers);
+    printf("- Waiting writers: %d\n", lock->waiting_writers);
+    printf("- Writer: %ld\n", lock->writer);
+    fflush(stdout);
+#endif
+
+    // The first condition is mandatory because the writer value on the rwlock
+    // struct don’t get reset when we unlock the rwlock. This is because the
+    // pthread_t type isn’t specified by the standard and can also be a struct,
+    // instead of an integer, in some implementations.
+    int is_writer = (lock->executing_writers == 1) &&
+                    (pthread_equal(lock->writer, pthread_self()) != 0);
+
+    if(is_writer) { // Writer
+        lock->executing_writers = 0;
+#ifdef DEBUG
+        calls_writer++;
+        printf("--------------------------------------------\n");
+        printf("WR_UNLOCK: %ld\n", pthread_self());
+        fflush(stdout);
+#endif
+
+        if(_uwr_signal_rd(lock)) {
+            if(lock->policy == RWLOCK_PHASE_FAIR) {
+                // Admit every waiting reader, even if writers are waiting
+                lock->reader_phase++;
+                lock->admitted_readers =
+                    lock->waiting_readers - lock->waiting_upgradeable;
+            }
+            pthread_cond_broadcast(&lock->cond_read);
+        }
+
+        if(_uwr_signal_wr(lock)) {
+            pthread_cond_signal(&lock->cond_write);
+        }
+
+    } else { // Reader
+        (lock->executing_readers)--;
+
+        if(lock->upgradeable_held &&
+           pthread_equal(lock->upgrader, pthread_self()) != 0) {
+            // The next upgradeable reader waits among the readers
+            lock->upgradeable_held = 0;
+            if(lock->waiting_readers > 0) {
+                pthread_cond_broadcast(&lock->cond_read);
+            }
+        } else if(lock->upgrading && lock->executing_readers == 1) {
+            pthread_cond_signal(&lock->cond_upgrade);
+        }
+#ifdef DEBUG
+        calls_reader++;
+        printf("--------------------------------------------\n");
+        printf("RD_UNLOCK: %ld\n", pthread_self());
+        fflush(stdout);
+#endif
+    }
+
+    if(_urd_signal_rd(lock)) {
+        pthread_cond_broadcast(&lock->cond_read);
+    }
+
+    if(_urd_signal_wr(lock)) {
+        pthread_cond_signal(&lock->cond_write);
+    }
+
+#ifdef DEBUG
+    printf("--------------------------------------------\n");
+    printf("- Executing readers: %d\n", lock->executing_readers);
+    printf("- Waiting readers: %d\n", lock->waiting_readers);
+    printf("- Executing writers: %d\n", lock->executing_writers);
+    printf("- Waiting writers: %d\n", lock->waiting_writers);
+    printf("- Writer: %ld\n", lock->writer);
+    fflush(stdout);
+#endif
+
+    if((ret = pthread_mutex_unlock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+    return 0;
+}
+
+static int _destroy(void *lock_p) {
+    cond_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+    if((ret = pthread_cond_destroy(&lock->cond_read)) != 0) {
+        return ret;
+    };
+
+    if((ret = pthread_cond_destroy(&lock->cond_write)) != 0) {
+        return ret;
+    };
+
+    if((ret = pthread_cond_destroy(&lock->cond_upgrade)) != 0) {
+        return ret;
+    };
+
+    if((ret = pthread_mutex_destroy(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_destroy(&lock->stats);
+#endif
+
+    free(lock);
+
+    return ret;
+}
+
+const struct rwlock_ops_s cond_rwlock_ops = {
+    .init = _init,
+    .rdlock = _rdlock,
+    .wrlock = _wrlock,
+    .unlock = _unlock,
+    .rdlock_upgradeable = _rdlock_upgradeable,
+    .upgrade = _upgrade,
+    .downgrade = _downgrade,
+    .destroy = _destroy,
+};
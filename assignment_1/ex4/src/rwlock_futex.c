@@ -0,0 +1,415 @@
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "rwlock_impl.h"
+#ifdef RWLOCK_STATS
+#include "histogram.h"
+#include "rwlock_stats.h"
+#endif
+
+/* Size of a cache line in bytes */
+#define CACHE_LINE 64
+
+/*
+ * Layout of the state word:
+ * - bits 0-15: number of executing readers.
+ * - bits 16-29: number of writers parked (or about to park) in the kernel.
+ * - bit 30: at least one reader is parked in the kernel.
+ * - bit 31: a writer is executing.
+ */
+#define READERS_MASK 0x0000ffffu
+#define WRITER_WAITING_ONE 0x00010000u
+#define WRITERS_WAITING_MASK 0x3fff0000u
+#define READERS_PARKED 0x40000000u
+#define WRITER_LOCKED 0x80000000u
+
+/* Upper bound of the spinning iterations before parking */
+#define SPIN_MAX 100
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX() __builtin_ia32_pause()
+#else
+#define CPU_RELAX() atomic_signal_fence(memory_order_seq_cst)
+#endif
+
+/*
+ * Futex rwlock.
+ *
+ * The whole lock is a single state word, so an uncontended acquisition is one
+ * compare-and-swap. Contended threads spin for an adaptive number of
+ * iterations and then park in the kernel: readers on the state word itself
+ * and writers on a separate sequence word, so that an unlocking thread wakes
+ * either all the parked readers or a single parked writer.
+ */
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_uint state;
+    atomic_uint writer_seq;
+    int policy;
+    /* Running average of the spins that led to an acquisition */
+    atomic_int spin_average;
+#ifdef RWLOCK_STATS
+    struct rwlock_stats_s *stats;
+#endif
+} futex_rwlock_s;
+
+/*
+ * Issue a futex system call on a word of the rwlock.
+ *
+ * Parameters:
+ * - addr: the futex word.
+ * - op: FUTEX_WAIT_PRIVATE or FUTEX_WAKE_PRIVATE.
+ * - val: the expected value for waits, the number of threads for wakes.
+ *
+ * Returns:
+ * - the return value of the system call.
+ */
+static long _futex(atomic_uint *addr, int op, unsigned int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+static int _init(void **lock_p, int policy) {
+    futex_rwlock_s *lock = aligned_alloc(CACHE_LINE, sizeof(futex_rwlock_s));
+
+    if((*lock_p = lock) == NULL) {
+        return 1;
+    };
+
+    lock->policy = policy;
+    atomic_init(&lock->state, 0);
+    atomic_init(&lock->writer_seq, 0);
+    atomic_init(&lock->spin_average, SPIN_MAX / 2);
+
+#ifdef RWLOCK_STATS
+    if(rwlock_stats_init(&lock->stats) != 0) {
+        return 1;
+    };
+#endif
+
+    return 0;
+}
+
+/*
+ * The predicate that determines if the rwlock can be acquired for reading.
+ *
+ * Parameters:
+ * - policy: the policy of the rwlock.
+ * - state: the state word of the rwlock.
+ *
+ * Returns:
+ * - 1 if the rwlock can be acquired for reading.
+ * - 0 if the rwlock cannot be acquired for reading.
+ */
+static int _rd_predicate(int policy, unsigned int state) {
+    int predicate;
+
+    if(policy == RWLOCK_READER_PRIORITY) {
+        // There is no executing writer
+        predicate = !(state & WRITER_LOCKED);
+    } else {
+        // There is no executing writer and no waiting writer
+        predicate = !(state & WRITER_LOCKED) && !(state & WRITERS_WAITING_MASK);
+    }
+
+    return predicate;
+}
+
+/*
+ * The predicate that determines if the rwlock can be acquired for writing.
+ *
+ * Parameters:
+ * - policy: the policy of the rwlock.
+ * - state: the state word of the rwlock.
+ *
+ * Returns:
+ * - 1 if the rwlock can be acquired for writing.
+ * - 0 if the rwlock cannot be acquired for writing.
+ */
+static int _rw_predicate(int policy, unsigned int state) {
+    int predicate;
+
+    if(policy == RWLOCK_READER_PRIORITY) {
+        // There is no executing or waiting reader and no executing writer
+        predicate = !(state & READERS_MASK) && !(state & READERS_PARKED) &&
+                    !(state & WRITER_LOCKED);
+    } else {
+        // There is no executing reader and no executing writer
+        predicate = !(state & READERS_MASK) && !(state & WRITER_LOCKED);
+    }
+
+    return predicate;
+}
+
+/*
+ * Get the number of spinning iterations before parking. The budget adapts to
+ * the spins that recent acquisitions needed, bounded by SPIN_MAX.
+ *
+ * Parameters:
+ * - lock: the rwlock to be acquired.
+ *
+ * Returns:
+ * - the number of spinning iterations.
+ */
+static int _spin_budget(const futex_rwlock_s *const lock) {
+    int budget =
+        2 * atomic_load_explicit(&lock->spin_average, memory_order_relaxed)
+        + 10;
+
+    return budget < SPIN_MAX ? budget : SPIN_MAX;
+}
+
+/*
+ * Move the running average of spins towards the spins of an acquisition.
+ *
+ * Parameters:
+ * - lock: the rwlock that was acquired.
+ * - spins: the spinning iterations of the acquisition.
+ */
+static void _spin_update(futex_rwlock_s *const lock, int spins) {
+    int average =
+        atomic_load_explicit(&lock->spin_average, memory_order_relaxed);
+
+    atomic_store_explicit(
+        &lock->spin_average, average + (spins - average) / 8,
+        memory_order_relaxed
+    );
+}
+
+/*
+ * Wake a single parked writer.
+ *
+ * Parameters:
+ * - lock: the rwlock the writer is parked on.
+ */
+static void _wake_writer(futex_rwlock_s *const lock) {
+    atomic_fetch_add(&lock->writer_seq, 1);
+    _futex(&lock->writer_seq, FUTEX_WAKE_PRIVATE, 1);
+}
+
+/*
+ * Acquire the rwlock for reading.
+ *
+ * Parameters:
+ * - lock: the rwlock to be locked.
+ * - wakeups: incremented every time the thread returns from the kernel.
+ *
+ * Returns:
+ * - 0 if the rwlock was acquired at once.
+ * - 1 if the thread had to spin or park.
+ */
+static int _rd_acquire(futex_rwlock_s *lock, int *wakeups) {
+    unsigned int state =
+        atomic_load_explicit(&lock->state, memory_order_relaxed);
+
+    // Uncontended path
+    if(_rd_predicate(lock->policy, state) &&
+       atomic_compare_exchange_weak(&lock->state, &state, state + 1)) {
+        return 0;
+    }
+
+    int budget = _spin_budget(lock);
+    for(int spins = 0; spins < budget; spins++) {
+        state = atomic_load_explicit(&lock->state, memory_order_relaxed);
+        if(_rd_predicate(lock->policy, state) &&
+           atomic_compare_exchange_weak(&lock->state, &state, state + 1)) {
+            _spin_update(lock, spins);
+            return 1;
+        }
+        CPU_RELAX();
+    }
+    _spin_update(lock, budget);
+
+    for(;;) {
+        state = atomic_load(&lock->state);
+
+        if(_rd_predicate(lock->policy, state)) {
+            if(atomic_compare_exchange_weak(
+                   &lock->state, &state, state + 1
+               )) {
+                return 1;
+            }
+            continue;
+        }
+
+        // Announce the parked reader before sleeping, so that the unlocking
+        // writer knows it has to wake the readers
+        if(!(state & READERS_PARKED)) {
+            if(!atomic_compare_exchange_weak(
+                   &lock->state, &state, state | READERS_PARKED
+               )) {
+                continue;
+            }
+            state |= READERS_PARKED;
+        }
+
+        _futex(&lock->state, FUTEX_WAIT_PRIVATE, state);
+        (*wakeups)++;
+    }
+}
+
+static int _rdlock(void *lock_p) {
+    futex_rwlock_s *lock = lock_p;
+    int wakeups = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int contended = _rd_acquire(lock, &wakeups);
+
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_READ, wait_start, contended, wakeups
+    );
+#else
+    _rd_acquire(lock, &wakeups);
+#endif
+
+    return 0;
+}
+
+/*
+ * Acquire the rwlock for writing.
+ *
+ * Parameters:
+ * - lock: the rwlock to be locked.
+ * - wakeups: incremented every time the thread returns from the kernel.
+ *
+ * Returns:
+ * - 0 if the rwlock was acquired at once.
+ * - 1 if the thread had to spin or park.
+ */
+static int _wr_acquire(futex_rwlock_s *lock, int *wakeups) {
+    unsigned int state =
+        atomic_load_explicit(&lock->state, memory_order_relaxed);
+
+    // Uncontended path
+    if(_rw_predicate(lock->policy, state) &&
+       atomic_compare_exchange_weak(
+           &lock->state, &state, state | WRITER_LOCKED
+       )) {
+        return 0;
+    }
+
+    int budget = _spin_budget(lock);
+    for(int spins = 0; spins < budget; spins++) {
+        state = atomic_load_explicit(&lock->state, memory_order_relaxed);
+        if(_rw_predicate(lock->policy, state) &&
+           atomic_compare_exchange_weak(
+               &lock->state, &state, state | WRITER_LOCKED
+           )) {
+            _spin_update(lock, spins);
+            return 1;
+        }
+        CPU_RELAX();
+    }
+    _spin_update(lock, budget);
+
+    // Register as a waiting writer, so that readers let it pass when writers
+    // have priority and the last reader knows it has to wake a writer
+    atomic_fetch_add(&lock->state, WRITER_WAITING_ONE);
+
+    for(;;) {
+        // Read the sequence before the state, any unlock that happens after
+        // the check changes the sequence and makes the wait return at once
+        unsigned int seq = atomic_load(&lock->writer_seq);
+        state = atomic_load(&lock->state);
+
+        if(_rw_predicate(lock->policy, state)) {
+            if(atomic_compare_exchange_weak(
+                   &lock->state, &state,
+                   (state - WRITER_WAITING_ONE) | WRITER_LOCKED
+               )) {
+                return 1;
+            }
+            continue;
+        }
+
+        _futex(&lock->writer_seq, FUTEX_WAIT_PRIVATE, seq);
+        (*wakeups)++;
+    }
+}
+
+static int _wrlock(void *lock_p) {
+    futex_rwlock_s *lock = lock_p;
+    int wakeups = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int contended = _wr_acquire(lock, &wakeups);
+
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_WRITE, wait_start, contended, wakeups
+    );
+#else
+    _wr_acquire(lock, &wakeups);
+#endif
+
+    return 0;
+}
+
+static int _unlock(void *lock_p) {
+    futex_rwlock_s *lock = lock_p;
+#ifdef RWLOCK_STATS
+    rwlock_stats_released(lock->stats);
+#endif
+
+    unsigned int state = atomic_load(&lock->state);
+    unsigned int new_state;
+
+    // No reader can hold the rwlock while the writer bit is set
+    if(state & WRITER_LOCKED) { // Writer
+        do {
+            new_state = state & ~WRITER_LOCKED;
+            // With writer priority, parked readers keep waiting while there
+            // are waiting writers
+            if(lock->policy == RWLOCK_READER_PRIORITY ||
+               !(state & WRITERS_WAITING_MASK)) {
+                new_state &= ~READERS_PARKED;
+            }
+        } while(!atomic_compare_exchange_weak(
+            &lock->state, &state, new_state
+        ));
+
+        if((state & READERS_PARKED) && !(new_state & READERS_PARKED)) {
+            _futex(&lock->state, FUTEX_WAKE_PRIVATE, INT_MAX);
+        }
+
+        if(lock->policy == RWLOCK_READER_PRIORITY) {
+            // Woken readers go first, the last of them wakes the writer
+            if(!(state & READERS_PARKED) && (state & WRITERS_WAITING_MASK)) {
+                _wake_writer(lock);
+            }
+        } else if(state & WRITERS_WAITING_MASK) {
+            _wake_writer(lock);
+        }
+    } else { // Reader
+        state = atomic_fetch_sub(&lock->state, 1);
+
+        if((state & READERS_MASK) == 1 && (state & WRITERS_WAITING_MASK)) {
+            _wake_writer(lock);
+        }
+    }
+
+    return 0;
+}
+
+static int _destroy(void *lock_p) {
+    futex_rwlock_s *lock = lock_p;
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_destroy(&lock->stats);
+#endif
+
+    free(lock);
+
+    return 0;
+}
+
+const struct rwlock_ops_s futex_rwlock_ops = {
+    .init = _init,
+    .rdlock = _rdlock,
+    .wrlock = _wrlock,
+    .unlock = _unlock,
+    .destroy = _destroy,
+};
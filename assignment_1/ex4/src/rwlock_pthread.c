@@ -0,0 +1,130 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "rwlock_impl.h"
+#ifdef RWLOCK_STATS
+#include "histogram.h"
+#include "rwlock_stats.h"
+#endif
+
+/*
+ * The rwlock of the pthread library, whose policy is left to the library.
+ */
+typedef struct {
+    pthread_rwlock_t lock;
+#ifdef RWLOCK_STATS
+    struct rwlock_stats_s *stats;
+#endif
+} default_rwlock_s;
+
+static int _init(void **lock_p, int policy) {
+    (void)policy;
+
+    default_rwlock_s *lock = malloc(sizeof(default_rwlock_s));
+
+    if((*lock_p = lock) == NULL) {
+        return 1;
+    };
+
+#ifdef RWLOCK_STATS
+    if(rwlock_stats_init(&lock->stats) != 0) {
+        return 1;
+    };
+#endif
+
+    return pthread_rwlock_init(&lock->lock, NULL);
+}
+
+static int _rdlock(void *lock_p) {
+    default_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int wakeups = 0;
+
+    // The library lock hides its waiters, try first to detect contention
+    if((ret = pthread_rwlock_tryrdlock(&lock->lock)) == EBUSY) {
+        wakeups = 1;
+        ret = pthread_rwlock_rdlock(&lock->lock);
+    }
+    if(ret != 0) {
+        return ret;
+    };
+
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_READ, wait_start, wakeups > 0, wakeups
+    );
+#else
+    if((ret = pthread_rwlock_rdlock(&lock->lock)) != 0) {
+        return ret;
+    };
+#endif
+
+    return 0;
+}
+
+static int _wrlock(void *lock_p) {
+    default_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int wakeups = 0;
+
+    // The library lock hides its waiters, try first to detect contention
+    if((ret = pthread_rwlock_trywrlock(&lock->lock)) == EBUSY) {
+        wakeups = 1;
+        ret = pthread_rwlock_wrlock(&lock->lock);
+    }
+    if(ret != 0) {
+        return ret;
+    };
+
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_WRITE, wait_start, wakeups > 0, wakeups
+    );
+#else
+    if((ret = pthread_rwlock_wrlock(&lock->lock)) != 0) {
+        return ret;
+    };
+#endif
+
+    return 0;
+}
+
+static int _unlock(void *lock_p) {
+    default_rwlock_s *lock = lock_p;
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_released(lock->stats);
+#endif
+
+    return pthread_rwlock_unlock(&lock->lock);
+}
+
+static int _destroy(void *lock_p) {
+    default_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+    if((ret = pthread_rwlock_destroy(&lock->lock)) != 0) {
+        return ret;
+    };
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_destroy(&lock->stats);
+#endif
+
+    free(lock);
+
+    return ret;
+}
+
+const struct rwlock_ops_s default_rwlock_ops = {
+    .init = _init,
+    .rdlock = _rdlock,
+    .wrlock = _wrlock,
+    .unlock = _unlock,
+    .destroy = _destroy,
+};
@@ -0,0 +1,218 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "rwlock_impl.h"
+#include "thread_slot.h"
+#ifdef RWLOCK_STATS
+#include "histogram.h"
+#include "rwlock_stats.h"
+#endif
+
+/* Size of a cache line in bytes */
+#define CACHE_LINE 64
+
+/* Number of reader indicators, threads share them modulo this number */
+#define READER_SLOTS 64
+
+/*
+ * A reader indicator. Each one fills a whole cache line, so that readers that
+ * use different slots never write to the same cache line.
+ */
+struct reader_slot_s {
+    _Alignas(CACHE_LINE) atomic_uint readers;
+};
+
+/*
+ * Read-mostly rwlock.
+ *
+ * A reader only increments the indicator of its own slot and checks that no
+ * writer is active, so readers do not serialize on a shared cache line when
+ * there is no writer. A writer takes the mutex, announces itself and then
+ * scans every slot until the readers drain. Readers that find an active
+ * writer retract their indicator and wait on the mutex, so the policy gives
+ * priority to writers.
+ */
+typedef struct {
+    pthread_mutex_t mutex_rw;
+    atomic_int writer_active;
+    atomic_int writer_slot;
+    struct reader_slot_s slots[READER_SLOTS];
+#ifdef RWLOCK_STATS
+    struct rwlock_stats_s *stats;
+#endif
+} read_mostly_rwlock_s;
+
+static int _init(void **lock_p, int policy) {
+    (void)policy;
+
+    read_mostly_rwlock_s *lock =
+        aligned_alloc(CACHE_LINE, sizeof(read_mostly_rwlock_s));
+
+    if((*lock_p = lock) == NULL) {
+        return 1;
+    };
+
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    if(rwlock_stats_init(&lock->stats) != 0) {
+        return 1;
+    };
+#endif
+
+    if((ret = pthread_mutex_init(&lock->mutex_rw, NULL)) != 0) {
+        return ret;
+    };
+
+    atomic_init(&lock->writer_active, 0);
+    atomic_init(&lock->writer_slot, -1);
+    for(int i = 0; i < READER_SLOTS; i++) {
+        atomic_init(&lock->slots[i].readers, 0);
+    }
+
+    return 0;
+}
+
+/*
+ * Get the reader indicator of the calling thread.
+ *
+ * Parameters:
+ * - lock: the rwlock holding the indicators.
+ *
+ * Returns:
+ * - the reader indicator of the calling thread.
+ */
+static struct reader_slot_s *_reader_slot(read_mostly_rwlock_s *const lock) {
+    return &lock->slots[thread_slot() % READER_SLOTS];
+}
+
+static int _rdlock(void *lock_p) {
+    read_mostly_rwlock_s *lock = lock_p;
+    struct reader_slot_s *slot = _reader_slot(lock);
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int wakeups = 0;
+#endif
+
+    for(;;) {
+        atomic_fetch_add(&slot->readers, 1);
+        if(!atomic_load(&lock->writer_active)) {
+#ifdef RWLOCK_STATS
+            rwlock_stats_acquired(
+                lock->stats, RWLOCK_STATS_READ, wait_start, wakeups > 0,
+                wakeups
+            );
+#endif
+            return 0;
+        }
+
+        // A writer is active or waiting for the readers to drain, back off
+        // and wait until it releases the mutex
+        atomic_fetch_sub(&slot->readers, 1);
+
+        if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+            return ret;
+        };
+        if((ret = pthread_mutex_unlock(&lock->mutex_rw)) != 0) {
+            return ret;
+        };
+#ifdef RWLOCK_STATS
+        wakeups++;
+#endif
+    }
+}
+
+static int _wrlock(void *lock_p) {
+    read_mostly_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+#ifdef RWLOCK_STATS
+    unsigned long long wait_start = histogram_time_ns();
+    int contended = 0;
+
+    // The mutex is held until the writer unlocks the rwlock
+    if((ret = pthread_mutex_trylock(&lock->mutex_rw)) == EBUSY) {
+        contended = 1;
+        ret = pthread_mutex_lock(&lock->mutex_rw);
+    }
+    if(ret != 0) {
+        return ret;
+    };
+#else
+    // The mutex is held until the writer unlocks the rwlock
+    if((ret = pthread_mutex_lock(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+#endif
+
+    atomic_store(&lock->writer_active, 1);
+    atomic_store(&lock->writer_slot, thread_slot());
+
+    for(int i = 0; i < READER_SLOTS; i++) {
+        while(atomic_load(&lock->slots[i].readers) != 0) {
+#ifdef RWLOCK_STATS
+            contended = 1;
+#endif
+            sched_yield();
+        }
+    }
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_acquired(
+        lock->stats, RWLOCK_STATS_WRITE, wait_start, contended, contended
+    );
+#endif
+
+    return 0;
+}
+
+static int _unlock(void *lock_p) {
+    read_mostly_rwlock_s *lock = lock_p;
+#ifdef RWLOCK_STATS
+    rwlock_stats_released(lock->stats);
+#endif
+
+    // Only the writer can find its own slot in the rwlock, slots are unique
+    // per thread
+    if(atomic_load(&lock->writer_slot) == thread_slot()) { // Writer
+        atomic_store(&lock->writer_slot, -1);
+        atomic_store(&lock->writer_active, 0);
+
+        return pthread_mutex_unlock(&lock->mutex_rw);
+    }
+
+    // Reader
+    atomic_fetch_sub(&_reader_slot(lock)->readers, 1);
+
+    return 0;
+}
+
+static int _destroy(void *lock_p) {
+    read_mostly_rwlock_s *lock = lock_p;
+    int ret = 0;
+
+    if((ret = pthread_mutex_destroy(&lock->mutex_rw)) != 0) {
+        return ret;
+    };
+
+#ifdef RWLOCK_STATS
+    rwlock_stats_destroy(&lock->stats);
+#endif
+
+    free(lock);
+
+    return ret;
+}
+
+const struct rwlock_ops_s read_mostly_rwlock_ops = {
+    .init = _init,
+    .rdlock = _rdlock,
+    .wrlock = _wrlock,
+    .unlock = _unlock,
+    .destroy = _destroy,
+};
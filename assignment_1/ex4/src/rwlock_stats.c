@@ -0,0 +1,153 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "histogram.h"
+#include "rwlock_stats.h"
+#include "thread_slot.h"
+
+/* Size of a cache line in bytes */
+#define CACHE_LINE 64
+
+/* The statistics of a mode of acquisition */
+struct mode_stats_s {
+    unsigned long long acquisitions;
+    unsigned long long contended;
+    unsigned long long futile_wakeups;
+    struct histogram_s wait;
+    struct histogram_s hold;
+};
+
+/* The buffer of a single thread */
+struct thread_stats_s {
+    _Alignas(CACHE_LINE) struct mode_stats_s modes[2];
+    /* The mode and the start of the current hold */
+    int hold_mode;
+    unsigned long long hold_start;
+};
+
+struct rwlock_stats_s {
+    struct thread_stats_s threads[RWLOCK_STATS_THREADS];
+    /* The events of the threads whose slot has no buffer */
+    atomic_ullong dropped;
+};
+
+int rwlock_stats_init(struct rwlock_stats_s **stats) {
+    if((*stats = aligned_alloc(CACHE_LINE, sizeof(struct rwlock_stats_s))) ==
+       NULL) {
+        return 1;
+    }
+
+    memset(*stats, 0, sizeof(struct rwlock_stats_s));
+    atomic_init(&(*stats)->dropped, 0);
+
+    return 0;
+}
+
+/*
+ * Get the buffer of the calling thread.
+ *
+ * Parameters:
+ * - stats: the statistics of the rwlock.
+ *
+ * Returns:
+ * - the buffer of the calling thread.
+ * - NULL if the thread is not recorded, in which case the event is counted
+ * as dropped.
+ */
+struct thread_stats_s *_thread_stats(struct rwlock_stats_s *stats) {
+    int slot = thread_slot();
+
+    if(slot >= RWLOCK_STATS_THREADS) {
+        atomic_fetch_add_explicit(&stats->dropped, 1, memory_order_relaxed);
+
+        return NULL;
+    }
+
+    return &stats->threads[slot];
+}
+
+void rwlock_stats_acquired(
+    struct rwlock_stats_s *stats, int mode, unsigned long long wait_start,
+    int contended, int wakeups
+) {
+    struct thread_stats_s *thread = _thread_stats(stats);
+    if(thread == NULL) {
+        return;
+    }
+
+    unsigned long long now = histogram_time_ns();
+    struct mode_stats_s *mode_stats = &thread->modes[mode];
+
+    mode_stats->acquisitions++;
+    mode_stats->contended += contended;
+    // The last wakeup of a waiting thread is the one that acquires the rwlock
+    mode_stats->futile_wakeups += wakeups > 0 ? wakeups - 1 : 0;
+    histogram_record(&mode_stats->wait, now - wait_start);
+
+    thread->hold_mode = mode;
+    thread->hold_start = now;
+}
+
+void rwlock_stats_released(struct rwlock_stats_s *stats) {
+    struct thread_stats_s *thread = _thread_stats(stats);
+    if(thread == NULL) {
+        return;
+    }
+
+    histogram_record(
+        &thread->modes[thread->hold_mode].hold,
+        histogram_time_ns() - thread->hold_start
+    );
+}
+
+void rwlock_stats_destroy(struct rwlock_stats_s **stats) {
+    const char *mode_names[2] = {"Read", "Write"};
+    char name[64];
+
+    for(int mode = 0; mode < 2; mode++) {
+        struct mode_stats_s total;
+        memset(&total, 0, sizeof(struct mode_stats_s));
+
+        for(int i = 0; i < RWLOCK_STATS_THREADS; i++) {
+            struct mode_stats_s *thread = &(*stats)->threads[i].modes[mode];
+
+            total.acquisitions += thread->acquisitions;
+            total.contended += thread->contended;
+            total.futile_wakeups += thread->futile_wakeups;
+            histogram_merge(&total.wait, &thread->wait);
+            histogram_merge(&total.hold, &thread->hold);
+        }
+
+        printf(
+            "%s lock acquisitions = %llu (contended = %llu, futile wakeups = "
+            "%llu)\n",
+            mode_names[mode], total.acquisitions, total.contended,
+            total.futile_wakeups
+        );
+
+        snprintf(
+            name, sizeof(name), "%s lock wait time (ns)", mode_names[mode]
+        );
+        histogram_print(&total.wait, name);
+
+        snprintf(
+            name, sizeof(name), "%s lock hold time (ns)", mode_names[mode]
+        );
+        histogram_print(&total.hold, name);
+    }
+
+    unsigned long long dropped = atomic_load(&(*stats)->dropped);
+    if(dropped > 0) {
+        fprintf(
+            stderr,
+            "Warning: %llu events of threads beyond the first %d were not "
+            "recorded\n",
+            dropped, RWLOCK_STATS_THREADS
+        );
+    }
+
+    free(*stats);
+    *stats = NULL;
+}
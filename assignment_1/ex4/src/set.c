@@ -0,0 +1,91 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "set.h"
+
+static const struct set_ops_s *const implementations[] = {
+    &list_set_ops,
+    &unrolled_set_ops,
+    &rcu_set_ops,
+    &sharded_hash_set_ops,
+    &sharded_range_set_ops,
+    &flat_combining_set_ops,
+    &cow_array_set_ops,
+};
+
+#define IMPLEMENTATIONS                                                        \
+    ((int)(sizeof(implementations) / sizeof(implementations[0])))
+
+int set_implementation_count(void) { return IMPLEMENTATIONS; }
+
+const struct set_ops_s *set_implementation(int index) {
+    return implementations[index];
+}
+
+const struct set_ops_s *set_find(const char *name) {
+    for(int i = 0; i < IMPLEMENTATIONS; i++) {
+        if(strcmp(implementations[i]->name, name) == 0) {
+            return implementations[i];
+        }
+    }
+
+    return NULL;
+}
+
+int set_compare_keys(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+void set_sort_batch(int *values, int count) {
+    for(int i = 1; i < count; i++) {
+        if(values[i - 1] > values[i]) {
+            qsort(values, count, sizeof(int), set_compare_keys);
+            return;
+        }
+    }
+}
+
+void set_iterator_init(struct set_iterator_s *iterator) {
+    iterator->keys = NULL;
+    iterator->count = 0;
+    iterator->next = 0;
+    iterator->copy = NULL;
+    iterator->capacity = 0;
+}
+
+int set_iterator_append(struct set_iterator_s *iterator, int value) {
+    if(iterator->count == iterator->capacity) {
+        int capacity = iterator->capacity > 0 ? 2 * iterator->capacity : 64;
+        int *copy = realloc(iterator->copy, capacity * sizeof(int));
+
+        if(copy == NULL) {
+            return 1;
+        }
+        iterator->copy = copy;
+        iterator->capacity = capacity;
+    }
+
+    iterator->copy[iterator->count++] = value;
+    iterator->keys = iterator->copy;
+
+    return 0;
+}
+
+int set_iterator_next(struct set_iterator_s *iterator, int *value_p) {
+    if(iterator->next >= iterator->count) {
+        return 0;
+    }
+
+    *value_p = iterator->keys[iterator->next++];
+
+    return 1;
+}
+
+void set_iterator_destroy(struct set_iterator_s *iterator) {
+    free(iterator->copy);
+    set_iterator_init(iterator);
+}
@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "linkedlist.h"
+#ifdef NODE_POOL
+#include "node_pool.h"
+#endif
+#include "rwlock.h"
+#include "set.h"
+
+/* The shards, every one a list with its own rwlock */
+static list_t *shards = NULL;
+static int shard_count = 0;
+
+/* If set, shard i holds the i-th range of keys, otherwise keys are hashed */
+static int by_range = 0;
+static int max_key = 1;
+
+/*
+ * Get the index of the shard of a value.
+ *
+ * Parameters:
+ * - value: the value.
+ *
+ * Returns:
+ * - the index of the shard that holds the value.
+ */
+static int _shard_index(int value) {
+    unsigned long long index;
+
+    if(by_range) {
+        index = (unsigned long long)value * shard_count / max_key;
+        if(index >= (unsigned long long)shard_count) {
+            index = shard_count - 1;
+        }
+    } else {
+        // Multiplicative hash, then the high bits pick the shard
+        unsigned hash = (unsigned)value * 2654435761u;
+        index = ((unsigned long long)hash * shard_count) >> 32;
+    }
+
+    return (int)index;
+}
+
+/*
+ * Get the shard of a value.
+ *
+ * Parameters:
+ * - value: the value.
+ *
+ * Returns:
+ * - the list of the shard that holds the value.
+ */
+static list_t _shard(int value) { return shards[_shard_index(value)]; }
+
+/*
+ * Initialize the shards.
+ *
+ * Parameters:
+ * - params: the parameters of the set.
+ * - range: 1 to partition the keys by range, 0 to hash them.
+ *
+ * Returns:
+ * - 0 if the shards were initialized successfully.
+ * - 1 if an error occurred.
+ */
+static int _init_shards(const struct set_params_s *params, int range) {
+    if(params->shards < 1 || params->max_key < 1) {
+        return 1;
+    }
+    if((shards = calloc(params->shards, sizeof(list_t))) == NULL) {
+        return 1;
+    }
+
+    shard_count = params->shards;
+    by_range = range;
+    max_key = params->max_key;
+
+    for(int i = 0; i < shard_count; i++) {
+        if(list_init(&shards[i], params->lock_name) != 0) {
+            while(--i >= 0) {
+                list_destroy(&shards[i]);
+            }
+            free(shards);
+            shards = NULL;
+            return 1;
+        }
+        list_use_fingers(shards[i], params->fingers);
+    }
+
+    return 0;
+}
+
+static int _init_hash(const struct set_params_s *params) {
+    return _init_shards(params, 0);
+}
+
+static int _init_range(const struct set_params_s *params) {
+    return _init_shards(params, 1);
+}
+
+static int _insert(int value) {
+    list_t list = _shard(value);
+
+    if(rwlock_wrlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_insert(list, value);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+static int _member(int value) {
+    list_t list = _shard(value);
+
+    if(rwlock_rdlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_member(list, value);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+static int _delete(int value) {
+    list_t list = _shard(value);
+
+    if(rwlock_wrlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    int rv = list_delete(list, value);
+    if(rwlock_unlock(list_rwlock(list)) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    return rv;
+}
+
+/*
+ * Print every shard on its own line. The shards of a range partitioned set
+ * are printed in the order of their keys.
+ */
+static void _print(void) {
+    for(int i = 0; i < shard_count; i++) {
+        printf("shard %d: ", i);
+        list_print(shards[i]);
+    }
+}
+
+/*
+ * Group the values by shard, keeping them in order within every shard, then
+ * bulk load every shard.
+ */
+static void _bulk_load(const int *values, int count) {
+    int *offsets = calloc(shard_count + 1, sizeof(int));
+    int *grouped = malloc(count * sizeof(int));
+
+    if(offsets == NULL || grouped == NULL) {
+        free(offsets);
+        free(grouped);
+        for(int i = count - 1; i >= 0; i--) {
+            _insert(values[i]);
+        }
+        return;
+    }
+
+    // Counting sort on the shard index, which is stable
+    for(int i = 0; i < count; i++) {
+        offsets[_shard_index(values[i]) + 1]++;
+    }
+    for(int i = 0; i < shard_count; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    for(int i = 0; i < count; i++) {
+        grouped[offsets[_shard_index(values[i])]++] = values[i];
+    }
+
+    // Every offset now points to the end of its shard
+    for(int i = 0, begin = 0; i < shard_count; i++) {
+        if(rwlock_wrlock(list_rwlock(shards[i])) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        list_bulk_load(shards[i], grouped + begin, offsets[i] - begin);
+        if(rwlock_unlock(list_rwlock(shards[i])) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        begin = offsets[i];
+    }
+
+    free(offsets);
+    free(grouped);
+}
+
+/*
+ * Read lock the shards that may hold values of [lo, hi), in index order so
+ * that concurrent scans cannot deadlock. Holding all of them at the same time
+ * makes the scan see the shards at a single point in time.
+ *
+ * Parameters:
+ * - lo: the smallest value of the range.
+ * - hi: the value after the largest value of the range.
+ * - first_p: set to the index of the first locked shard.
+ * - last_p: set to the index of the last locked shard.
+ */
+static void _lock_range(int lo, int hi, int *first_p, int *last_p) {
+    if(by_range) {
+        *first_p = _shard_index(lo < 0 ? 0 : lo);
+        *last_p = _shard_index(hi - 1 < 0 ? 0 : hi - 1);
+    } else {
+        *first_p = 0;
+        *last_p = shard_count - 1;
+    }
+
+    for(int i = *first_p; i <= *last_p; i++) {
+        if(rwlock_rdlock(list_rwlock(shards[i])) != 0) {
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/*
+ * Unlock the shards locked by _lock_range().
+ *
+ * Parameters:
+ * - first: the index of the first locked shard.
+ * - last: the index of the last locked shard.
+ */
+static void _unlock_range(int first, int last) {
+    for(int i = last; i >= first; i--) {
+        if(rwlock_unlock(list_rwlock(shards[i])) != 0) {
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static int _range_count(int lo, int hi) {
+    int first, last, count = 0;
+
+    if(lo >= hi) {
+        return 0;
+    }
+
+    _lock_range(lo, hi, &first, &last);
+    for(int i = first; i <= last; i++) {
+        count += list_range_count(shards[i], lo, hi);
+    }
+    _unlock_range(first, last);
+
+    return count;
+}
+
+/*
+ * Copy the values of every shard, then sort them outside of the locks unless
+ * the shards are ranges, whose values are already in order.
+ */
+static int _iterate(int lo, int hi, struct set_iterator_s *iterator) {
+    struct set_iterator_s shard_iterator;
+    int first, last, rv = 0;
+
+    set_iterator_init(iterator);
+    if(lo >= hi) {
+        return 0;
+    }
+
+    _lock_range(lo, hi, &first, &last);
+    for(int i = first; i <= last && rv == 0; i++) {
+        int value;
+
+        rv = list_iterate(shards[i], lo, hi, &shard_iterator);
+        while(rv == 0 && set_iterator_next(&shard_iterator, &value)) {
+            rv = set_iterator_append(iterator, value);
+        }
+        set_iterator_destroy(&shard_iterator);
+    }
+    _unlock_range(first, last);
+
+    if(rv != 0) {
+        set_iterator_destroy(iterator);
+        return 1;
+    }
+    // An empty snapshot has no copy, and a single value is already sorted
+    if(!by_range && iterator->count > 1) {
+        qsort(iterator->copy, iterator->count, sizeof(int), set_compare_keys);
+    }
+
+    return 0;
+}
+
+static void _free_list(void) {
+    for(int i = 0; i < shard_count; i++) {
+        list_destroy(&shards[i]);
+    }
+    free(shards);
+    shards = NULL;
+    shard_count = 0;
+#ifdef NODE_POOL
+    // Every node was returned to the pool, release its slabs
+    node_pool_destroy();
+#endif
+}
+
+const struct set_ops_s sharded_hash_set_ops = {
+    .name = "sharded_hash",
+    .synchronized = 1,
+    .own_rwlocks = 1,
+    .init = _init_hash,
+    .insert = _insert,
+    .print = _print,
+    .member = _member,
+    .delete = _delete,
+    .free_list = _free_list,
+    .bulk_load = _bulk_load,
+    .range_count = _range_count,
+    .iterate = _iterate,
+};
+
+const struct set_ops_s sharded_range_set_ops = {
+    .name = "sharded_range",
+    .synchronized = 1,
+    .own_rwlocks = 1,
+    .init = _init_range,
+    .insert = _insert,
+    .print = _print,
+    .member = _member,
+    .delete = _delete,
+    .free_list = _free_list,
+    .bulk_load = _bulk_load,
+    .range_count = _range_count,
+    .iterate = _iterate,
+};
@@ -0,0 +1,69 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "thread_slot.h"
+
+/* Guards the released slots and the slot that will be handed out next */
+static pthread_mutex_t slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* The slot that will be handed to the next thread if none was released */
+static int next_slot = 0;
+
+/* The slots released by the threads that exited, used as a stack */
+static int *released_slots = NULL;
+static int released_count = 0;
+static int released_capacity = 0;
+
+/* The key whose destructor releases the slot when the thread exits */
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+
+/* The slot of the calling thread, -1 until it is assigned */
+static __thread int my_slot = -1;
+
+/*
+ * Give the slot of an exiting thread back, so that the next thread can reuse
+ * it. If the slot cannot be recorded it is lost, which only leaves a gap.
+ *
+ * Parameters:
+ * - value: the slot plus one, as stored in the key.
+ */
+static void _release_slot(void *value) {
+    int slot = (int)(intptr_t)value - 1;
+
+    pthread_mutex_lock(&slots_mutex);
+    if(released_count == released_capacity) {
+        int capacity = released_capacity > 0 ? 2 * released_capacity : 16;
+        int *slots = realloc(released_slots, capacity * sizeof(int));
+
+        if(slots != NULL) {
+            released_slots = slots;
+            released_capacity = capacity;
+        }
+    }
+    if(released_count < released_capacity) {
+        released_slots[released_count++] = slot;
+    }
+    pthread_mutex_unlock(&slots_mutex);
+}
+
+static void _create_slot_key(void) {
+    pthread_key_create(&slot_key, _release_slot);
+}
+
+int thread_slot(void) {
+    if(my_slot < 0) {
+        pthread_once(&slot_key_once, _create_slot_key);
+
+        pthread_mutex_lock(&slots_mutex);
+        my_slot = released_count > 0 ? released_slots[--released_count]
+                                     : next_slot++;
+        pthread_mutex_unlock(&slots_mutex);
+
+        // A non-NULL value makes the destructor run when the thread exits
+        pthread_setspecific(slot_key, (void *)(intptr_t)(my_slot + 1));
+    }
+
+    return my_slot;
+}
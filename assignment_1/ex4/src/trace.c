@@ -0,0 +1,152 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+_Static_assert(
+    sizeof(struct operation_s) == 8, "a trace record should take 8 bytes"
+);
+
+int trace_write(
+    const char *path, const struct operation_s *const *thread_ops,
+    const int *thread_counts, int thread_count
+) {
+    struct trace_header_s header;
+    struct trace_section_s section;
+    FILE *file;
+
+    if(thread_count < 1 || thread_count > UINT16_MAX + 1) {
+        return 1;
+    }
+    if((file = fopen(path, "wb")) == NULL) {
+        return 1;
+    }
+
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.thread_count = thread_count;
+    header.record_count = 0;
+    for(int i = 0; i < thread_count; i++) {
+        header.record_count += thread_counts[i];
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    section.offset = 0;
+    for(int i = 0; i < thread_count && ok; i++) {
+        section.count = thread_counts[i];
+        ok = fwrite(&section, sizeof(section), 1, file) == 1;
+        section.offset += section.count;
+    }
+    for(int i = 0; i < thread_count && ok; i++) {
+        ok = fwrite(
+                 thread_ops[i], sizeof(struct operation_s), thread_counts[i],
+                 file
+             ) == (size_t)thread_counts[i];
+    }
+
+    if(fclose(file) != 0) {
+        ok = 0;
+    }
+
+    return !ok;
+}
+
+int trace_open(struct trace_s *trace, const char *path) {
+    struct stat st;
+    int fd;
+
+    memset(trace, 0, sizeof(struct trace_s));
+
+    if((fd = open(path, O_RDONLY)) < 0) {
+        return 1;
+    }
+    if(fstat(fd, &st) != 0 ||
+       (size_t)st.st_size < sizeof(struct trace_header_s)) {
+        close(fd);
+        return 1;
+    }
+
+    trace->size = st.st_size;
+    trace->map =
+        mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if(trace->map == MAP_FAILED) {
+        trace->map = NULL;
+        return 1;
+    }
+
+    const struct trace_header_s *header = trace->map;
+    const struct trace_section_s *sections =
+        (const struct trace_section_s *)(header + 1);
+    const struct operation_s *records =
+        (const struct operation_s *)(sections + header->thread_count);
+
+    if(memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+       header->version != TRACE_VERSION || header->thread_count < 1 ||
+       header->thread_count > UINT16_MAX + 1 ||
+       (trace->size - sizeof(struct trace_header_s)) /
+               sizeof(struct trace_section_s) <
+           header->thread_count) {
+        trace_close(trace);
+        return 1;
+    }
+
+    size_t records_size =
+        trace->size - ((const char *)records - (const char *)trace->map);
+
+    if(header->record_count != records_size / sizeof(struct operation_s)) {
+        trace_close(trace);
+        return 1;
+    }
+
+    trace->thread_count = header->thread_count;
+    trace->record_count = header->record_count;
+    trace->thread_ops =
+        malloc(trace->thread_count * sizeof(struct operation_s *));
+    trace->thread_counts = malloc(trace->thread_count * sizeof(int));
+    if(trace->thread_ops == NULL || trace->thread_counts == NULL) {
+        trace_close(trace);
+        return 1;
+    }
+
+    for(int i = 0; i < trace->thread_count; i++) {
+        const struct trace_section_s *section = &sections[i];
+
+        if(section->offset > header->record_count ||
+           section->count > header->record_count - section->offset ||
+           section->count > INT32_MAX) {
+            trace_close(trace);
+            return 1;
+        }
+
+        trace->thread_ops[i] = records + section->offset;
+        trace->thread_counts[i] = (int)section->count;
+
+        // Every record should belong to the section of its thread
+        for(int j = 0; j < trace->thread_counts[i]; j++) {
+            const struct operation_s *op = &trace->thread_ops[i][j];
+
+            if(op->thread != i || op->type > OP_DELETE) {
+                trace_close(trace);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void trace_close(struct trace_s *trace) {
+    if(trace->map != NULL) {
+        munmap(trace->map, trace->size);
+    }
+    free(trace->thread_ops);
+    free(trace->thread_counts);
+    memset(trace, 0, sizeof(struct trace_s));
+}
@@ -0,0 +1,385 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "set.h"
+
+/* Size of a cache line in bytes */
+#define CACHE_LINE 64
+
+/* Number of keys that fit in a node of one cache line */
+#define NODE_KEYS ((CACHE_LINE - sizeof(void *) - sizeof(int)) / sizeof(int))
+
+/* A node with fewer keys than this is merged with or refilled from the next */
+#define NODE_MIN_KEYS (NODE_KEYS / 2)
+
+/*
+ * Struct for list nodes.
+ *
+ * Every node keeps a sorted array of keys, and all the keys of a node are
+ * smaller than the keys of the following node. A node is never empty.
+ */
+struct list_node_s {
+    struct list_node_s *next;
+    int count;
+    int keys[NODE_KEYS];
+};
+
+_Static_assert(
+    sizeof(struct list_node_s) == CACHE_LINE,
+    "a list node should fill exactly one cache line"
+);
+
+/* The head of the list */
+static struct list_node_s *head = NULL;
+
+/* Searches start from the finger of the thread when they can */
+static int use_fingers = 0;
+
+/* Incremented every time a node is freed, invalidating the fingers */
+static unsigned long delete_epoch = 0;
+
+/*
+ * The finger of the thread: the last node that a search of the thread went
+ * past, still in the list as long as the delete epoch has not changed.
+ */
+static __thread struct {
+    struct list_node_s *node;
+    unsigned long delete_epoch;
+} finger;
+
+/*
+ * Allocate an empty list node aligned to a cache line.
+ *
+ * Returns:
+ * - a pointer to the node.
+ * - NULL if an error occurred.
+ */
+static struct list_node_s *_alloc_node(void) {
+    struct list_node_s *node =
+        aligned_alloc(CACHE_LINE, sizeof(struct list_node_s));
+
+    if(node != NULL) {
+        node->next = NULL;
+        node->count = 0;
+    }
+
+    return node;
+}
+
+/*
+ * Find the node that should hold a value, i.e. the first node whose largest
+ * key is not smaller than the value.
+ *
+ * Parameters:
+ * - value: the value to be searched.
+ * - pred_p: set to the node before the returned one (NULL for the head).
+ *
+ * Returns:
+ * - the node that should hold the value.
+ * - NULL if the value is larger than every key of the list.
+ */
+static struct list_node_s *
+_find_node(int value, struct list_node_s **pred_p) {
+    struct list_node_s *curr = head;
+    struct list_node_s *pred = NULL;
+
+    // Every node before the finger has smaller keys, so the search can
+    // resume after it when its largest key is smaller than the value
+    if(use_fingers && finger.node != NULL &&
+       finger.delete_epoch == delete_epoch &&
+       finger.node->keys[finger.node->count - 1] < value) {
+        pred = finger.node;
+        curr = pred->next;
+    }
+
+    while(curr != NULL && curr->keys[curr->count - 1] < value) {
+        pred = curr;
+        curr = curr->next;
+    }
+
+    if(use_fingers && pred != NULL) {
+        finger.node = pred;
+        finger.delete_epoch = delete_epoch;
+    }
+
+    *pred_p = pred;
+
+    return curr;
+}
+
+/*
+ * Find the position of a value inside a node.
+ *
+ * Parameters:
+ * - node: the node to be searched.
+ * - value: the value to be searched.
+ *
+ * Returns:
+ * - the index of the first key that is not smaller than the value.
+ */
+static int _find_position(const struct list_node_s *const node, int value) {
+    int pos = 0;
+
+    while(pos < node->count && node->keys[pos] < value)
+        pos++;
+
+    return pos;
+}
+
+static int _insert(int value) {
+    struct list_node_s *pred;
+    struct list_node_s *curr = _find_node(value, &pred);
+    struct list_node_s *temp;
+    int pos;
+
+    if(curr == NULL) {
+        if(pred == NULL) { /* empty list */
+            if((temp = _alloc_node()) == NULL) {
+                return 0;
+            }
+            temp->keys[0] = value;
+            temp->count = 1;
+            head = temp;
+
+            return 1;
+        }
+
+        /* value is larger than every key, append to the last node */
+        curr = pred;
+    }
+
+    pos = _find_position(curr, value);
+    if(pos < curr->count && curr->keys[pos] == value) { /* value in list */
+        return 0;
+    }
+
+    if(curr->count == NODE_KEYS) { /* split the full node in half */
+        int half = NODE_KEYS / 2;
+
+        if((temp = _alloc_node()) == NULL) {
+            return 0;
+        }
+        for(int i = half; i < curr->count; i++) {
+            temp->keys[i - half] = curr->keys[i];
+        }
+        temp->count = curr->count - half;
+        curr->count = half;
+
+        temp->next = curr->next;
+        curr->next = temp;
+
+        if(pos > half) {
+            curr = temp;
+            pos -= half;
+        }
+    }
+
+    for(int i = curr->count; i > pos; i--) {
+        curr->keys[i] = curr->keys[i - 1];
+    }
+    curr->keys[pos] = value;
+    curr->count++;
+
+    return 1;
+}
+
+static void _print(void) {
+    struct list_node_s *temp;
+
+    printf("list = ");
+
+    temp = head;
+    while(temp != (struct list_node_s *)NULL) {
+        for(int i = 0; i < temp->count; i++) {
+            printf("%d ", temp->keys[i]);
+        }
+        temp = temp->next;
+    }
+    printf("\n");
+}
+
+static int _member(int value) {
+    struct list_node_s *pred;
+    struct list_node_s *temp = _find_node(value, &pred);
+    int pos = 0;
+
+    if(temp != NULL) {
+        pos = _find_position(temp, value);
+    }
+
+    if(temp == NULL || temp->keys[pos] > value) {
+#ifdef DEBUG
+        printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+        printf("MEMBER(): %d is not in the list\n", value);
+        printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+#endif
+        return 0;
+    } else {
+#ifdef DEBUG
+        printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+        printf("MEMBER(): %d is in the list\n", value);
+        printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+#endif
+        return 1;
+    }
+}
+
+static int _delete(int value) {
+    struct list_node_s *pred;
+    struct list_node_s *curr = _find_node(value, &pred);
+    struct list_node_s *following;
+    int pos;
+
+    if(curr == NULL) { /* Not in list */
+        return 0;
+    }
+
+    pos = _find_position(curr, value);
+    if(curr->keys[pos] != value) { /* Not in list */
+        return 0;
+    }
+
+#ifdef DEBUG
+    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    printf("DELETE(): Removing %d\n", value);
+    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+#endif
+
+    curr->count--;
+    for(int i = pos; i < curr->count; i++) {
+        curr->keys[i] = curr->keys[i + 1];
+    }
+
+    if(curr->count >= (int)NODE_MIN_KEYS) {
+        return 1;
+    }
+
+    following = curr->next;
+    if(following != NULL) {
+        if(curr->count + following->count <= (int)NODE_KEYS) {
+            /* merge the following node into the current one */
+            for(int i = 0; i < following->count; i++) {
+                curr->keys[curr->count + i] = following->keys[i];
+            }
+            curr->count += following->count;
+            curr->next = following->next;
+            delete_epoch++;
+            free(following);
+        } else {
+            /* move keys from the following node to balance the two */
+            int moved = (following->count - curr->count) / 2;
+
+            for(int i = 0; i < moved; i++) {
+                curr->keys[curr->count + i] = following->keys[i];
+            }
+            for(int i = moved; i < following->count; i++) {
+                following->keys[i - moved] = following->keys[i];
+            }
+            curr->count += moved;
+            following->count -= moved;
+        }
+    } else if(curr->count == 0) { /* last node became empty */
+        if(pred == NULL)
+            head = NULL;
+        else
+            pred->next = NULL;
+        delete_epoch++;
+        free(curr);
+    }
+
+    return 1;
+}
+
+/*
+ * Fill the empty list with full nodes, in order.
+ */
+static void _bulk_load(const int *values, int count) {
+    struct list_node_s **link = &head;
+    struct list_node_s *temp;
+
+    for(int i = 0; i < count; i += NODE_KEYS) {
+        if((temp = _alloc_node()) == NULL) {
+            return;
+        }
+        while(temp->count < (int)NODE_KEYS && i + temp->count < count) {
+            temp->keys[temp->count] = values[i + temp->count];
+            temp->count++;
+        }
+        *link = temp;
+        link = &temp->next;
+    }
+}
+
+/*
+ * Count the keys in [lo, hi), skipping the nodes before the range by their
+ * largest key and counting whole nodes inside it.
+ */
+static int _range_count(int lo, int hi) {
+    struct list_node_s *pred;
+    struct list_node_s *temp = _find_node(lo, &pred);
+    int count = 0;
+
+    for(; temp != NULL && temp->keys[0] < hi; temp = temp->next) {
+        if(temp->keys[0] >= lo && temp->keys[temp->count - 1] < hi) {
+            count += temp->count;
+            continue;
+        }
+        for(int i = 0; i < temp->count; i++) {
+            count += temp->keys[i] >= lo && temp->keys[i] < hi;
+        }
+    }
+
+    return count;
+}
+
+static int _iterate(int lo, int hi, struct set_iterator_s *iterator) {
+    struct list_node_s *pred;
+    struct list_node_s *temp = _find_node(lo, &pred);
+
+    set_iterator_init(iterator);
+
+    for(; temp != NULL && temp->keys[0] < hi; temp = temp->next) {
+        for(int i = 0; i < temp->count && temp->keys[i] < hi; i++) {
+            if(temp->keys[i] >= lo &&
+               set_iterator_append(iterator, temp->keys[i]) != 0) {
+                set_iterator_destroy(iterator);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void _free_list(void) {
+    struct list_node_s *current = head;
+    struct list_node_s *following;
+
+    while(current != NULL) {
+        following = current->next;
+        free(current);
+        current = following;
+    }
+
+    head = NULL;
+    delete_epoch++;
+}
+
+static int _init(const struct set_params_s *params) {
+    use_fingers = params->fingers;
+
+    return 0;
+}
+
+const struct set_ops_s unrolled_set_ops = {
+    .name = "unrolled",
+    .init = _init,
+    .insert = _insert,
+    .print = _print,
+    .member = _member,
+    .delete = _delete,
+    .free_list = _free_list,
+    .bulk_load = _bulk_load,
+    .range_count = _range_count,
+    .iterate = _iterate,
+};
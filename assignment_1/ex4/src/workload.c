@@ -0,0 +1,363 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "my_rand.h"
+#include "workload.h"
+
+/*
+ * Sampler of a zipf distribution over the ranks [1, n], rank k having a
+ * probability proportional to 1 / k^theta. It uses rejection-inversion
+ * sampling (Hormann and Derflinger), so setting it up takes constant time
+ * whatever the number of ranks, and drawing a rank takes one or two random
+ * numbers on average.
+ */
+struct zipf_s {
+    double theta;
+    double n;
+    double h_integral_x1;
+    double h_integral_n;
+    double s;
+};
+
+/* Per-thread state of the generator */
+struct generator_s {
+    const struct workload_s *workload;
+    unsigned seed;
+    /* The keys of the thread are in [base, base + span) */
+    int base;
+    int span;
+    /* Position of the sequential distribution */
+    long next;
+    struct zipf_s zipf;
+    /* Ring of the most recent inserts of the latest distribution */
+    int *recent;
+    long recent_count;
+};
+
+/*
+ * (exp(x) - 1) / x, accurate near 0.
+ */
+double _zipf_helper_expm1(double x) {
+    if(fabs(x) > 1e-8) {
+        return expm1(x) / x;
+    }
+    return 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + x * 0.25));
+}
+
+/*
+ * log(1 + x) / x, accurate near 0.
+ */
+double _zipf_helper_log1p(double x) {
+    if(fabs(x) > 1e-8) {
+        return log1p(x) / x;
+    }
+    return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+/*
+ * The unnormalized density 1 / x^theta.
+ */
+double _zipf_h(const struct zipf_s *zipf, double x) {
+    return exp(-zipf->theta * log(x));
+}
+
+/*
+ * An integral of _zipf_h().
+ */
+double _zipf_h_integral(const struct zipf_s *zipf, double x) {
+    double log_x = log(x);
+    return _zipf_helper_expm1((1.0 - zipf->theta) * log_x) * log_x;
+}
+
+/*
+ * The inverse of _zipf_h_integral().
+ */
+double _zipf_h_integral_inverse(const struct zipf_s *zipf, double x) {
+    double t = x * (1.0 - zipf->theta);
+    if(t < -1.0) {
+        t = -1.0;
+    }
+    return exp(_zipf_helper_log1p(t) * x);
+}
+
+/*
+ * Set up the sampler of a zipf distribution.
+ *
+ * Parameters:
+ * - zipf: the sampler.
+ * - n: the number of ranks.
+ * - theta: the skew of the distribution.
+ */
+void _zipf_init(struct zipf_s *zipf, long n, double theta) {
+    zipf->theta = theta;
+    zipf->n = (double)n;
+    zipf->h_integral_x1 = _zipf_h_integral(zipf, 1.5) - 1.0;
+    zipf->h_integral_n = _zipf_h_integral(zipf, zipf->n + 0.5);
+    zipf->s = 2.0 - _zipf_h_integral_inverse(
+                        zipf, _zipf_h_integral(zipf, 2.5) - _zipf_h(zipf, 2.0)
+                    );
+}
+
+/*
+ * Draw a rank from the zipf distribution.
+ *
+ * Returns:
+ * - the rank, in [1, n].
+ */
+long _zipf_next(const struct zipf_s *zipf, unsigned *seed) {
+    for(;;) {
+        double u = zipf->h_integral_n +
+                   my_drand(seed) * (zipf->h_integral_x1 - zipf->h_integral_n);
+        double x = _zipf_h_integral_inverse(zipf, u);
+        long k = (long)(x + 0.5);
+
+        if(k < 1) {
+            k = 1;
+        } else if(k > zipf->n) {
+            k = (long)zipf->n;
+        }
+
+        if(k - x <= zipf->s ||
+           u >= _zipf_h_integral(zipf, k + 0.5) - _zipf_h(zipf, k)) {
+            return k;
+        }
+    }
+}
+
+/*
+ * Scatter an index over [0, span), so that the hot keys are spread over the
+ * sorted set instead of being its smallest keys.
+ */
+int _scatter(unsigned long long index, int span) {
+    // Finalizer of splitmix64
+    index += 0x9e3779b97f4a7c15ULL;
+    index = (index ^ (index >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    index = (index ^ (index >> 27)) * 0x94d049bb133111ebULL;
+    index ^= index >> 31;
+
+    return (int)(index % (unsigned long long)span);
+}
+
+/*
+ * Draw the key of an operation.
+ *
+ * Parameters:
+ * - generator: the generator of the thread.
+ * - type: the operation.
+ *
+ * Returns:
+ * - the key.
+ */
+int _next_key(struct generator_s *generator, int type) {
+    const struct workload_s *workload = generator->workload;
+    int key;
+
+    switch(workload->distribution) {
+    case WORKLOAD_ZIPF:
+        key = _scatter(_zipf_next(&generator->zipf, &generator->seed) - 1,
+                       generator->span);
+        break;
+    case WORKLOAD_HOTSPOT: {
+        int hot = (int)(workload->hot_fraction * generator->span);
+
+        if(hot < 1) {
+            hot = 1;
+        }
+        if(my_drand(&generator->seed) < workload->hot_probability ||
+           hot == generator->span) {
+            key = _scatter(my_rand(&generator->seed) % hot, generator->span);
+        } else {
+            key = _scatter(
+                hot + my_rand(&generator->seed) % (generator->span - hot),
+                generator->span
+            );
+        }
+        break;
+    }
+    case WORKLOAD_SEQUENTIAL:
+        key = (int)(generator->next++ % generator->span);
+        break;
+    case WORKLOAD_LATEST:
+        if(type == OP_INSERT || generator->recent_count == 0) {
+            key = my_rand(&generator->seed) % generator->span;
+            if(type == OP_INSERT) {
+                generator->recent
+                    [generator->recent_count++ % WORKLOAD_LATEST_WINDOW] = key;
+            }
+        } else {
+            long window = generator->recent_count < WORKLOAD_LATEST_WINDOW
+                              ? generator->recent_count
+                              : WORKLOAD_LATEST_WINDOW;
+            struct zipf_s zipf;
+
+            // The number of recent inserts grows, so does the distribution
+            _zipf_init(&zipf, window, workload->theta);
+            long chosen = generator->recent_count -
+                          _zipf_next(&zipf, &generator->seed);
+            key = generator->recent[chosen % WORKLOAD_LATEST_WINDOW];
+        }
+        break;
+    default: /* WORKLOAD_UNIFORM */
+        key = my_rand(&generator->seed) % generator->span;
+        break;
+    }
+
+    return generator->base + key;
+}
+
+void workload_init(
+    struct workload_s *workload, int max_key, double search_percent,
+    double insert_percent, double delete_percent
+) {
+    memset(workload, 0, sizeof(struct workload_s));
+    workload->distribution = WORKLOAD_UNIFORM;
+    workload->max_key = max_key;
+    workload->phase_count = 1;
+    workload->phases[0].fraction = 1.0;
+    workload->phases[0].search_percent = search_percent;
+    workload->phases[0].insert_percent = insert_percent;
+    workload->phases[0].delete_percent = delete_percent;
+}
+
+int workload_parse_distribution(
+    struct workload_s *workload, const char *description
+) {
+    char extra;
+
+    if(strcmp(description, "uniform") == 0) {
+        workload->distribution = WORKLOAD_UNIFORM;
+    } else if(strcmp(description, "sequential") == 0) {
+        workload->distribution = WORKLOAD_SEQUENTIAL;
+    } else if(sscanf(description, "zipf:%lf%c", &workload->theta, &extra) ==
+              1) {
+        workload->distribution = WORKLOAD_ZIPF;
+    } else if(sscanf(description, "hotspot:%lf:%lf%c", &workload->hot_fraction,
+                     &workload->hot_probability, &extra) == 2) {
+        if(workload->hot_fraction <= 0.0 || workload->hot_fraction > 1.0) {
+            return 1;
+        }
+        workload->distribution = WORKLOAD_HOTSPOT;
+    } else if(strcmp(description, "latest") == 0) {
+        workload->distribution = WORKLOAD_LATEST;
+        workload->theta = 0.99;
+    } else if(sscanf(description, "latest:%lf%c", &workload->theta, &extra) ==
+              1) {
+        workload->distribution = WORKLOAD_LATEST;
+    } else {
+        return 1;
+    }
+
+    return workload->theta < 0.0;
+}
+
+int workload_parse_phases(
+    struct workload_s *workload, const char *description
+) {
+    int count = 0;
+    int length;
+
+    while(*description != '\0') {
+        struct workload_phase_s *phase = &workload->phases[count];
+
+        if(count == WORKLOAD_MAX_PHASES ||
+           sscanf(description, "%lf:%lf:%lf:%lf%n", &phase->fraction,
+                  &phase->search_percent, &phase->insert_percent,
+                  &phase->delete_percent, &length) != 4 ||
+           phase->fraction < 0.0) {
+            return 1;
+        }
+        count++;
+
+        description += length;
+        if(*description == ',' && description[1] != '\0') {
+            description++;
+        } else if(*description != '\0') {
+            return 1;
+        }
+    }
+
+    if(count == 0) {
+        return 1;
+    }
+    workload->phase_count = count;
+
+    return 0;
+}
+
+int workload_phase_begin(
+    const struct workload_s *workload, int phase, int ops_per_thread
+) {
+    double total = 0.0, before = 0.0;
+
+    for(int i = 0; i < workload->phase_count; i++) {
+        total += workload->phases[i].fraction;
+        if(i < phase) {
+            before += workload->phases[i].fraction;
+        }
+    }
+
+    if(phase >= workload->phase_count || total <= 0.0) {
+        return phase > 0 ? ops_per_thread : 0;
+    }
+
+    return (int)(before / total * ops_per_thread + 0.5);
+}
+
+int workload_generate(
+    const struct workload_s *workload, long rank, int thread_count,
+    struct operation_s *ops, int ops_per_thread
+) {
+    struct generator_s generator = {.workload = workload, .seed = rank + 1};
+
+    if(workload->partitioned) {
+        generator.span = workload->max_key / thread_count;
+        generator.base = rank * generator.span;
+    } else {
+        generator.span = workload->max_key;
+        generator.base = 0;
+    }
+    if(generator.span < 1) {
+        generator.span = 1;
+    }
+
+    // Threads that walk the same keys start from different offsets
+    if(!workload->partitioned) {
+        generator.next = (long)generator.span * rank / thread_count;
+    }
+    if(workload->distribution == WORKLOAD_ZIPF) {
+        _zipf_init(&generator.zipf, generator.span, workload->theta);
+    }
+    if(workload->distribution == WORKLOAD_LATEST) {
+        generator.recent = malloc(WORKLOAD_LATEST_WINDOW * sizeof(int));
+        if(generator.recent == NULL) {
+            return 1;
+        }
+    }
+
+    for(int phase = 0; phase < workload->phase_count; phase++) {
+        const struct workload_phase_s *mix = &workload->phases[phase];
+        int end = workload_phase_begin(workload, phase + 1, ops_per_thread);
+
+        for(int i = workload_phase_begin(workload, phase, ops_per_thread);
+            i < end; i++) {
+            double which_op = my_drand(&generator.seed);
+
+            if(which_op < mix->search_percent) {
+                ops[i].type = OP_MEMBER;
+            } else if(which_op < mix->search_percent + mix->insert_percent) {
+                ops[i].type = OP_INSERT;
+            } else {
+                ops[i].type = OP_DELETE;
+            }
+            ops[i].key = _next_key(&generator, ops[i].type);
+            ops[i].thread = (uint16_t)rank;
+            ops[i].reserved = 0;
+        }
+    }
+
+    free(generator.recent);
+
+    return 0;
+}
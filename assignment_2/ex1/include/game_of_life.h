@@ -61,6 +61,40 @@ int gol_parse_input_from_file(
  */
 void gol_random_input(const game_of_life_t *const gol);
 
+/*
+ * Select the engine that executes the generations. The naive engine, which
+ * stores one int per cell, is selected when the object is initialized.
+ *
+ * Parameters:
+ * - gol: the game of life object.
+ * - name: the name of the engine (see gol_engine_name()).
+ *
+ * Returns:
+ * - 0 if the function executed successfully.
+ * - 1 if there is no engine with that name.
+ */
+int gol_set_engine(const game_of_life_t *const gol, const char *const name);
+
+/*
+ * Get the number of available engines.
+ *
+ * Returns:
+ * - the number of engines.
+ */
+int gol_engine_count(void);
+
+/*
+ * Get the name of an engine.
+ *
+ * Parameters:
+ * - index: the index of the engine, from 0 to gol_engine_count() - 1.
+ *
+ * Returns:
+ * - the name of the engine.
+ * - NULL if index is out of range.
+ */
+const char *gol_engine_name(const int index);
+
 /*
  * Execute the game of life for a given number of generations.
  *
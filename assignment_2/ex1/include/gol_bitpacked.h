@@ -0,0 +1,115 @@
+#ifndef __GOL_BITPACKED_H__
+#define __GOL_BITPACKED_H__
+
+#include <stdint.h>
+
+#include "gol_engine.h"
+
+/* Cells stored in a word */
+#define WORD_BITS 64
+
+/*
+ * The cells of a generation, one bit per cell. Bit b of word k of a row is
+ * the cell of column WORD_BITS * k + b. Every row has a zero word before and
+ * after its cells and a zero row lies above and below the grid, so that the
+ * cells outside of the grid are dead.
+ */
+struct bitpacked_s {
+    uint64_t *input_ptr;
+    uint64_t *output_ptr;
+    /* The edge size of the grid, without the borders */
+    int cells;
+    /* The words of the cells of a row */
+    int words;
+    /* The words of a row, including the zero words */
+    int stride;
+    /* The bits of the last word of a row that are cells of the grid */
+    uint64_t last_mask;
+};
+
+/*
+ * Pack the dense grid of the game of life object into bits.
+ *
+ * Parameters:
+ * - packed: the packed grid.
+ * - gol: the game of life object.
+ * - extra_rows: the zero rows allocated below the one below the grid, for
+ * the engines that read past it.
+ *
+ * Returns:
+ * - 0 if the function executed successfully.
+ * - 1 if there an error occurred.
+ */
+int bitpacked_init(
+    struct bitpacked_s *const packed, const game_of_life_t *const gol,
+    const int extra_rows
+);
+
+/*
+ * Unpack the bits into the dense grid of the game of life object and free
+ * the packed grid.
+ *
+ * Parameters:
+ * - packed: the packed grid.
+ * - gol: the game of life object.
+ */
+void bitpacked_destroy(
+    struct bitpacked_s *const packed, const game_of_life_t *const gol
+);
+
+/*
+ * Compute the next generation of a word of a row, 64 cells at a time.
+ *
+ * The eight neighbors of the cells of a word are eight words, one bit per
+ * cell. They are summed bit by bit with full adders, so that every bit
+ * position holds the count of its own cell: ones is the bit of weight 1 of
+ * the count, twos the bit of weight 2 and more is set when the count is 4 or
+ * greater. A cell is alive in the next generation if its count is 3, or if
+ * it is 2 and the cell is alive.
+ *
+ * Parameters:
+ * - packed: the packed grid.
+ * - i: the row, from 1 to the edge size of the grid.
+ * - k: the word, from 1 to the words of the cells of a row.
+ *
+ * Returns:
+ * - the word in the next generation, without bits past the east edge.
+ */
+static inline uint64_t bitpacked_word(
+    const struct bitpacked_s *const packed, const int i, const int k
+) {
+    const uint64_t *above = packed->input_ptr + packed->stride * (i - 1);
+    const uint64_t *row = packed->input_ptr + packed->stride * i;
+    const uint64_t *below = packed->input_ptr + packed->stride * (i + 1);
+
+    // The west neighbor of bit b is bit b - 1, the east one bit b + 1
+    uint64_t n = above[k];
+    uint64_t nw = (n << 1) | (above[k - 1] >> (WORD_BITS - 1));
+    uint64_t ne = (n >> 1) | (above[k + 1] << (WORD_BITS - 1));
+    uint64_t w = (row[k] << 1) | (row[k - 1] >> (WORD_BITS - 1));
+    uint64_t e = (row[k] >> 1) | (row[k + 1] << (WORD_BITS - 1));
+    uint64_t s = below[k];
+    uint64_t sw = (s << 1) | (below[k - 1] >> (WORD_BITS - 1));
+    uint64_t se = (s >> 1) | (below[k + 1] << (WORD_BITS - 1));
+
+    // Full adders of the neighbors, carries weigh twice their inputs
+    uint64_t s1 = nw ^ n ^ ne;
+    uint64_t c1 = (nw & n) | (ne & (nw ^ n));
+    uint64_t s2 = w ^ e ^ sw;
+    uint64_t c2 = (w & e) | (sw & (w ^ e));
+    uint64_t s3 = s ^ se;
+    uint64_t c3 = s & se;
+    uint64_t ones = s1 ^ s2 ^ s3;
+    uint64_t c4 = (s1 & s2) | (s3 & (s1 ^ s2));
+
+    // Sum of the carries c1 + c2 + c3 + c4, i.e. count / 2
+    uint64_t s5 = c1 ^ c2 ^ c3;
+    uint64_t c5 = (c1 & c2) | (c3 & (c1 ^ c2));
+    uint64_t twos = s5 ^ c4;
+    uint64_t more = c5 | (s5 & c4);
+    uint64_t next = twos & ~more & (ones | row[k]);
+
+    // The bits past the east edge are not cells of the grid
+    return k == packed->words ? next & packed->last_mask : next;
+}
+#endif
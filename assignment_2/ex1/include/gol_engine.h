@@ -0,0 +1,93 @@
+#ifndef __GOL_ENGINE_H__
+#define __GOL_ENGINE_H__
+
+#include "game_of_life.h"
+
+/*
+ * The engines of the game of life share the game of life object, whose
+ * dense grid of ints is the state exchanged with the rest of the program.
+ * An engine that keeps its own representation of the cells imports the
+ * dense grid when the execution starts and exports the final state to it
+ * when the execution ends.
+ */
+
+struct game_of_life_s {
+    /*
+     * The pointer to the input matrix.
+     *
+     * It is assumed that stores the initial state of the cells. After the
+     * simulation, it will store the final state of the cells (or the input to
+     * the generation that might follow).
+     */
+    int *input_ptr;
+    /*
+     * The pointer to the output matrix.
+     *
+     * It will be used as a buffer to store the intermediate state of the
+     * cells. After the simulation, it will not store any relevant information
+     * to any generations that might follow.
+     */
+    int *output_ptr;
+    /*
+     * The edge size of the grid plus the borders.
+     */
+    int grid;
+    /*
+     * The engine that executes the generations.
+     */
+    const struct gol_engine_s *engine;
+};
+
+/*
+ * An engine of the game of life. The cells outside of the grid are dead, as
+ * the borders of the dense grid are, except for the hashlife engine, which
+ * simulates the unbounded plane and writes back the cells inside the grid.
+ */
+struct gol_engine_s {
+    const char *name;
+    /*
+     * Same as gol_execute() and gol_execute_parallel(): the initial state is
+     * read from and the final state is written to the input matrix.
+     */
+    void (*execute)(const game_of_life_t *const gol, const int generations);
+    void (*execute_parallel)(
+        const game_of_life_t *const gol, const int generations,
+        const int threads
+    );
+};
+
+/* The engine of game_of_life.c, one int per cell */
+extern const struct gol_engine_s gol_naive_engine;
+
+/* The engine of gol_bitpacked.c, one bit per cell */
+extern const struct gol_engine_s gol_bitpacked_engine;
+
+/* The engine of gol_simd.c, one byte per cell */
+extern const struct gol_engine_s gol_simd_engine;
+
+/* The engine of gol_lut.c, one bit per cell and 2x2 cells per lookup */
+extern const struct gol_engine_s gol_lut_engine;
+
+/* The engine of gol_hashlife.c, a hash-consed quadtree */
+extern const struct gol_engine_s gol_hashlife_engine;
+
+/* The engine of gol_tiles.c, one bit per cell and only the active tiles */
+extern const struct gol_engine_s gol_tiles_engine;
+
+/* The engine of gol_temporal.c, one bit per cell and many generations a pass */
+extern const struct gol_engine_s gol_temporal_engine;
+
+/*
+ * Print the cells of the grid.
+ *
+ * The alive cells are drawn as 'o', the dead cells are drawn as ' '
+ * and the horizontal and vertical border cells are drawn as '-' and '|',
+ * respectively.
+ *
+ * Parameters:
+ * - arr_ptr: the matrix.
+ * - size: the size of the matrix.
+ */
+void print_cells(const int *const arr_ptr, const int size);
+
+#endif
@@ -1,6 +1,7 @@
 #include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 
 #ifdef DEBUG
@@ -8,31 +9,21 @@
 #define WAIT_US 200000
 #endif
 
-#include "game_of_life.h"
-
-struct game_of_life_s {
-    /*
-     * The pointer to the input matrix.
-     *
-     * It is assumed that stores the initial state of the cells. After the
-     * simulation, it will store the final state of the cells (or the input to
-     * the generation that might follow).
-     */
-    int *input_ptr;
-    /*
-     * The pointer to the output matrix.
-     *
-     * It will be used as a buffer to store the intermediate state of the
-     * cells. After the simulation, it will not store any relevant information
-     * to any generations that might follow.
-     */
-    int *output_ptr;
-    /*
-     * The edge size of the grid plus the borders.
-     */
-    int grid;
+#include "gol_engine.h"
+
+/* Every engine, the first one is the default */
+static const struct gol_engine_s *const engines[] = {
+    &gol_naive_engine,
+    &gol_bitpacked_engine,
+    &gol_simd_engine,
+    &gol_lut_engine,
+    &gol_hashlife_engine,
+    &gol_tiles_engine,
+    &gol_temporal_engine,
 };
 
+#define ENGINE_COUNT ((int)(sizeof(engines) / sizeof(engines[0])))
+
 int gol_init(game_of_life_t *const gol, const int grid) {
     if((*gol = malloc(sizeof(struct game_of_life_s))) == NULL) {
         return 1;
@@ -59,6 +50,7 @@ int gol_init(game_of_life_t *const gol, const int grid) {
     (*gol)->input_ptr = input_ptr;
     (*gol)->output_ptr = output_ptr;
     (*gol)->grid = grid + 2;
+    (*gol)->engine = engines[0];
 
     return 0;
 }
@@ -113,17 +105,6 @@ void gol_random_input(const game_of_life_t *const gol) {
     }
 }
 
-/*
- * Print the cells of the grid.
- *
- * The alive cells are drawn as 'o', the dead cells are drawn as ' '
- * and the horizontal and vertical border cells are drawn as '-' and '|',
- * respectively.
- *
- * Parameters:
- * - arr_ptr: the matrix.
- * - size: the size of the matrix.
- */
 void print_cells(const int *const arr_ptr, const int size) {
     for(int i = 0; i < size; i++) {
         for(int j = 0; j < size; j++)
@@ -139,7 +120,9 @@ void print_cells(const int *const arr_ptr, const int size) {
     }
 }
 
-void gol_execute(const game_of_life_t *const gol, const int generations) {
+static void execute_naive(
+    const game_of_life_t *const gol, const int generations
+) {
     int neighbors;
     int *temp_ptr;
 
@@ -193,7 +176,7 @@ void gol_execute(const game_of_life_t *const gol, const int generations) {
     }
 }
 
-void gol_execute_parallel(
+static void execute_parallel_naive(
     const game_of_life_t *const gol, const int generations, const int threads
 ) {
     int neighbors;
@@ -264,3 +247,40 @@ void gol_execute_parallel(
         }
     }
 }
+
+const struct gol_engine_s gol_naive_engine = {
+    .name = "naive",
+    .execute = execute_naive,
+    .execute_parallel = execute_parallel_naive,
+};
+
+int gol_set_engine(const game_of_life_t *const gol, const char *const name) {
+    for(int i = 0; i < ENGINE_COUNT; i++) {
+        if(strcmp(engines[i]->name, name) == 0) {
+            (*gol)->engine = engines[i];
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int gol_engine_count(void) { return ENGINE_COUNT; }
+
+const char *gol_engine_name(const int index) {
+    if(index < 0 || index >= ENGINE_COUNT) {
+        return NULL;
+    }
+
+    return engines[index]->name;
+}
+
+void gol_execute(const game_of_life_t *const gol, const int generations) {
+    (*gol)->engine->execute(gol, generations);
+}
+
+void gol_execute_parallel(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    (*gol)->engine->execute_parallel(gol, generations, threads);
+}
@@ -0,0 +1,154 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gol_bitpacked.h"
+
+int bitpacked_init(
+    struct bitpacked_s *const packed, const game_of_life_t *const gol,
+    const int extra_rows
+) {
+    packed->cells = (*gol)->grid - 2;
+    packed->words = (packed->cells + WORD_BITS - 1) / WORD_BITS;
+    packed->stride = packed->words + 2;
+    packed->last_mask = packed->cells % WORD_BITS == 0
+                            ? ~UINT64_C(0)
+                            : (UINT64_C(1) << packed->cells % WORD_BITS) - 1;
+
+    size_t size = (size_t)(packed->cells + 2 + extra_rows) * packed->stride;
+
+    packed->input_ptr = calloc(size, sizeof(uint64_t));
+    packed->output_ptr = calloc(size, sizeof(uint64_t));
+    if(packed->input_ptr == NULL || packed->output_ptr == NULL) {
+        free(packed->input_ptr);
+        free(packed->output_ptr);
+
+        return 1;
+    }
+
+    for(int i = 1; i <= packed->cells; i++) {
+        const int *row = (*gol)->input_ptr + (*gol)->grid * i + 1;
+        uint64_t *words = packed->input_ptr + packed->stride * i + 1;
+
+        for(int j = 0; j < packed->cells; j++) {
+            words[j / WORD_BITS] |= (uint64_t)(row[j] != 0) << j % WORD_BITS;
+        }
+    }
+
+    return 0;
+}
+
+void bitpacked_destroy(
+    struct bitpacked_s *const packed, const game_of_life_t *const gol
+) {
+    for(int i = 1; i <= packed->cells; i++) {
+        int *row = (*gol)->input_ptr + (*gol)->grid * i + 1;
+        const uint64_t *words = packed->input_ptr + packed->stride * i + 1;
+
+        for(int j = 0; j < packed->cells; j++) {
+            row[j] = (words[j / WORD_BITS] >> j % WORD_BITS) & 1;
+        }
+    }
+
+    free(packed->input_ptr);
+    free(packed->output_ptr);
+}
+
+/*
+ * Compute the next generation of a row.
+ *
+ * Parameters:
+ * - packed: the packed grid.
+ * - i: the row, from 1 to the edge size of the grid.
+ */
+static void bitpacked_row(const struct bitpacked_s *const packed, const int i) {
+    uint64_t *out = packed->output_ptr + packed->stride * i;
+
+    for(int k = 1; k <= packed->words; k++) {
+        out[k] = bitpacked_word(packed, i, k);
+    }
+}
+
+static void execute_bitpacked(
+    const game_of_life_t *const gol, const int generations
+) {
+    struct bitpacked_s packed;
+    uint64_t *temp_ptr;
+
+    if(bitpacked_init(&packed, gol, 0) != 0) {
+        fprintf(stderr, "Error: unable to pack the grid, using naive.\n");
+        gol_naive_engine.execute(gol, generations);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+    for(int gen = 0; gen < generations; gen++) {
+        for(int i = 1; i <= packed.cells; i++) {
+            bitpacked_row(&packed, i);
+        }
+
+        temp_ptr = packed.input_ptr;
+        packed.input_ptr = packed.output_ptr;
+        packed.output_ptr = temp_ptr;
+    }
+
+    bitpacked_destroy(&packed, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+static void execute_parallel_bitpacked(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    struct bitpacked_s packed;
+    uint64_t *temp_ptr;
+
+    if(bitpacked_init(&packed, gol, 0) != 0) {
+        fprintf(stderr, "Error: unable to pack the grid, using naive.\n");
+        gol_naive_engine.execute_parallel(gol, generations, threads);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+#pragma omp parallel num_threads(threads) default(none)                        \
+    shared(packed, generations, temp_ptr)
+    {
+        for(int gen = 0; gen < generations; gen++) {
+#pragma omp for schedule(static)
+            for(int i = 1; i <= packed.cells; i++) {
+                bitpacked_row(&packed, i);
+            }
+
+#pragma omp single
+            {
+                temp_ptr = packed.input_ptr;
+                packed.input_ptr = packed.output_ptr;
+                packed.output_ptr = temp_ptr;
+            }
+        }
+    }
+
+    bitpacked_destroy(&packed, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+const struct gol_engine_s gol_bitpacked_engine = {
+    .name = "bitpacked",
+    .execute = execute_bitpacked,
+    .execute_parallel = execute_parallel_bitpacked,
+};
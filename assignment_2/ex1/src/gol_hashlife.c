@@ -0,0 +1,602 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gol_engine.h"
+
+/*
+ * Nodes kept before the garbage collector runs. The collector first frees
+ * the nodes that are not reachable, from the universe or from the memoized
+ * results, and if that is not enough to halve them it evicts the memoized
+ * results as well.
+ */
+#ifndef HASHLIFE_MAX_NODES
+#define HASHLIFE_MAX_NODES (1 << 22)
+#endif
+
+/* Buckets of the hash table when the engine starts */
+#define INITIAL_BUCKETS (1 << 16)
+
+/* Levels of the universe, its edge is at most 2^MAX_LEVEL cells */
+#define MAX_LEVEL 60
+
+/*
+ * A square of 2^level x 2^level cells. Nodes are hash-consed: two nodes with
+ * the same quadrants are the same node, so a pattern that repeats in space
+ * or in time is stored and advanced once. A node of level 0 is a single cell.
+ */
+struct hl_node_s {
+    struct hl_node_s *nw;
+    struct hl_node_s *ne;
+    struct hl_node_s *sw;
+    struct hl_node_s *se;
+    /*
+     * The center of the node, of level - 1, after 2^result_step generations.
+     * NULL if not computed yet.
+     */
+    struct hl_node_s *result;
+    /* The next node in the same bucket of the hash table */
+    struct hl_node_s *next;
+    int level;
+    int result_step;
+    /* Alive cell, for level 0 */
+    int alive;
+    /* Set by the garbage collector on the reachable nodes */
+    int marked;
+};
+
+/* The two cells, the only nodes of level 0 and not in the hash table */
+static struct hl_node_s leaves[2] = {{.alive = 0}, {.alive = 1}};
+
+/* The hash table of the nodes of level 1 and above */
+static struct hl_node_s **buckets = NULL;
+static size_t bucket_count = 0;
+static size_t node_count = 0;
+
+/* The node count that triggers the garbage collector */
+static size_t gc_threshold = HASHLIFE_MAX_NODES;
+
+/* The empty node of every level, built on demand */
+static struct hl_node_s *empty[MAX_LEVEL + 1];
+
+/*
+ * The nodes being computed, which the garbage collector should not free.
+ * Every function that builds nodes pushes the ones it still needs here.
+ */
+static struct hl_node_s **stack = NULL;
+static size_t stack_size = 0;
+static size_t stack_capacity = 0;
+
+/*
+ * The universe and the position of its north-west cell, relative to the
+ * north-west cell of the grid.
+ */
+static struct hl_node_s *root = NULL;
+static int64_t root_x = 0;
+static int64_t root_y = 0;
+
+static void push(struct hl_node_s *node) {
+    if(stack_size == stack_capacity) {
+        stack_capacity = stack_capacity > 0 ? 2 * stack_capacity : 256;
+        if((stack = realloc(stack, stack_capacity * sizeof(*stack))) == NULL) {
+            fprintf(stderr, "Error: out of memory in hashlife.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    stack[stack_size++] = node;
+}
+
+static size_t hash(
+    const struct hl_node_s *nw, const struct hl_node_s *ne,
+    const struct hl_node_s *sw, const struct hl_node_s *se
+) {
+    uint64_t h = (uintptr_t)nw;
+
+    h = h * 0x9e3779b97f4a7c15 + (uintptr_t)ne;
+    h = h * 0x9e3779b97f4a7c15 + (uintptr_t)sw;
+    h = h * 0x9e3779b97f4a7c15 + (uintptr_t)se;
+
+    return (h ^ (h >> 29)) & (bucket_count - 1);
+}
+
+/*
+ * Double the buckets of the hash table.
+ */
+static void rehash(void) {
+    struct hl_node_s **old = buckets;
+    size_t old_count = bucket_count;
+
+    bucket_count = old_count > 0 ? 2 * old_count : INITIAL_BUCKETS;
+    if((buckets = calloc(bucket_count, sizeof(*buckets))) == NULL) {
+        fprintf(stderr, "Error: out of memory in hashlife.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t b = 0; b < old_count; b++) {
+        struct hl_node_s *node = old[b];
+
+        while(node != NULL) {
+            struct hl_node_s *next = node->next;
+            size_t h = hash(node->nw, node->ne, node->sw, node->se);
+
+            node->next = buckets[h];
+            buckets[h] = node;
+            node = next;
+        }
+    }
+
+    free(old);
+}
+
+static void mark(struct hl_node_s *node, const int keep_results) {
+    while(node != NULL && node->level > 0 && !node->marked) {
+        node->marked = 1;
+        mark(node->nw, keep_results);
+        mark(node->ne, keep_results);
+        mark(node->sw, keep_results);
+        if(keep_results) {
+            mark(node->result, keep_results);
+        }
+        node = node->se;
+    }
+}
+
+/*
+ * Forget the results that are not marked, free the nodes that are not marked
+ * and clear the marks. The results are forgotten first, since they may point
+ * to nodes about to be freed.
+ */
+static void sweep(void) {
+    for(size_t b = 0; b < bucket_count; b++) {
+        for(struct hl_node_s *node = buckets[b]; node != NULL;
+            node = node->next) {
+            if(node->result != NULL && !node->result->marked) {
+                node->result = NULL;
+            }
+        }
+    }
+
+    for(size_t b = 0; b < bucket_count; b++) {
+        struct hl_node_s **link = &buckets[b];
+
+        while(*link != NULL) {
+            struct hl_node_s *node = *link;
+
+            if(!node->marked) {
+                *link = node->next;
+                free(node);
+                node_count--;
+                continue;
+            }
+            node->marked = 0;
+            link = &node->next;
+        }
+    }
+}
+
+/*
+ * Free the nodes that are not reachable from the universe, the empty nodes,
+ * the stack or the extra roots.
+ *
+ * Parameters:
+ * - extra: the extra roots.
+ * - extra_count: the number of extra roots.
+ * - keep_results: 1 to keep the memoized results, 0 to evict them.
+ */
+static void collect(
+    struct hl_node_s *const *extra, const int extra_count,
+    const int keep_results
+) {
+    mark(root, keep_results);
+    for(int l = 0; l <= MAX_LEVEL; l++) {
+        mark(empty[l], keep_results);
+    }
+    for(size_t i = 0; i < stack_size; i++) {
+        mark(stack[i], keep_results);
+    }
+    for(int i = 0; i < extra_count; i++) {
+        mark(extra[i], keep_results);
+    }
+    sweep();
+}
+
+/*
+ * Run the garbage collector, keeping the quadrants of the node about to be
+ * built.
+ */
+static void gc(struct hl_node_s *const quadrants[4]) {
+    collect(quadrants, 4, 1);
+    if(node_count > HASHLIFE_MAX_NODES / 2) {
+        collect(quadrants, 4, 0);
+    }
+
+    // Do not collect again until the surviving nodes have doubled
+    gc_threshold = node_count * 2 > HASHLIFE_MAX_NODES ? node_count * 2
+                                                        : HASHLIFE_MAX_NODES;
+}
+
+/*
+ * Get the node made of four quadrants, building it if it does not exist.
+ *
+ * Parameters:
+ * - nw, ne, sw, se: the quadrants, of the same level.
+ *
+ * Returns:
+ * - the node.
+ */
+static struct hl_node_s *join(
+    struct hl_node_s *nw, struct hl_node_s *ne, struct hl_node_s *sw,
+    struct hl_node_s *se
+) {
+    size_t h = hash(nw, ne, sw, se);
+
+    for(struct hl_node_s *node = buckets[h]; node != NULL; node = node->next) {
+        if(node->nw == nw && node->ne == ne && node->sw == sw &&
+           node->se == se) {
+            return node;
+        }
+    }
+
+    if(node_count >= gc_threshold) {
+        struct hl_node_s *quadrants[4] = {nw, ne, sw, se};
+
+        gc(quadrants);
+    }
+    if(node_count >= bucket_count) {
+        rehash();
+    }
+
+    struct hl_node_s *node = malloc(sizeof(struct hl_node_s));
+
+    if(node == NULL) {
+        fprintf(stderr, "Error: out of memory in hashlife.\n");
+        exit(EXIT_FAILURE);
+    }
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->result = NULL;
+    node->level = nw->level + 1;
+    node->result_step = -1;
+    node->alive = 0;
+    node->marked = 0;
+
+    h = hash(nw, ne, sw, se);
+    node->next = buckets[h];
+    buckets[h] = node;
+    node_count++;
+
+    return node;
+}
+
+static struct hl_node_s *empty_node(const int level) {
+    if(empty[level] == NULL) {
+        struct hl_node_s *e = level > 0 ? empty_node(level - 1) : &leaves[0];
+
+        empty[level] = level > 0 ? join(e, e, e, e) : e;
+    }
+
+    return empty[level];
+}
+
+/*
+ * The center of a node, of level - 1, without advancing it.
+ */
+static struct hl_node_s *center(const struct hl_node_s *node) {
+    return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+/*
+ * Advance the 2x2 center of a node of level 2 by one generation.
+ */
+static struct hl_node_s *step_leaf(const struct hl_node_s *node) {
+    const struct hl_node_s *quadrants[4] = {
+        node->nw, node->ne, node->sw, node->se
+    };
+    int cells[4][4];
+    struct hl_node_s *next[4];
+
+    for(int q = 0; q < 4; q++) {
+        int r = 2 * (q / 2);
+        int c = 2 * (q % 2);
+
+        cells[r][c] = quadrants[q]->nw->alive;
+        cells[r][c + 1] = quadrants[q]->ne->alive;
+        cells[r + 1][c] = quadrants[q]->sw->alive;
+        cells[r + 1][c + 1] = quadrants[q]->se->alive;
+    }
+
+    for(int q = 0; q < 4; q++) {
+        int r = 1 + q / 2;
+        int c = 1 + q % 2;
+        int neighbors = -cells[r][c];
+
+        for(int dr = -1; dr <= 1; dr++) {
+            for(int dc = -1; dc <= 1; dc++) {
+                neighbors += cells[r + dr][c + dc];
+            }
+        }
+        next[q] = &leaves[neighbors == 3 || (cells[r][c] && neighbors == 2)];
+    }
+
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+/*
+ * Advance the center of a node by 2^j generations.
+ *
+ * The node is split into 3x3 overlapping subnodes of level - 1, whose
+ * centers are advanced by 2^j generations (or by 2^(j - 1) when j is as
+ * large as possible) and joined into 2x2 nodes of level - 1. The centers of
+ * these are the result, advanced by 2^(j - 1) more generations in the second
+ * case. Results are memoized in the nodes, so a subnode that appears again
+ * is not advanced again.
+ *
+ * Parameters:
+ * - node: the node, of level 2 or above, reachable by the collector.
+ * - j: the log2 of the generations, from 0 to the level of the node minus 2.
+ *
+ * Returns:
+ * - the center of the node, of level - 1, after 2^j generations.
+ */
+static struct hl_node_s *step(struct hl_node_s *node, const int j) {
+    if(node->result != NULL && node->result_step == j) {
+        return node->result;
+    }
+
+    size_t base = stack_size;
+    struct hl_node_s *result;
+
+    if(node->level == 2) {
+        result = step_leaf(node);
+    } else {
+        const int fast = j == node->level - 2;
+        const int sub_j = fast ? j - 1 : j;
+        struct hl_node_s *sub[3][3];
+        struct hl_node_s *next[3][3];
+        struct hl_node_s *quadrant[2][2];
+
+        sub[0][0] = node->nw;
+        sub[0][2] = node->ne;
+        sub[2][0] = node->sw;
+        sub[2][2] = node->se;
+        push(sub[0][1] = join(
+                 node->nw->ne, node->ne->nw, node->nw->se, node->ne->sw
+             ));
+        push(sub[1][0] = join(
+                 node->nw->sw, node->nw->se, node->sw->nw, node->sw->ne
+             ));
+        push(sub[1][1] = join(
+                 node->nw->se, node->ne->sw, node->sw->ne, node->se->nw
+             ));
+        push(sub[1][2] = join(
+                 node->ne->sw, node->ne->se, node->se->nw, node->se->ne
+             ));
+        push(sub[2][1] = join(
+                 node->sw->ne, node->se->nw, node->sw->se, node->se->sw
+             ));
+
+        for(int r = 0; r < 3; r++) {
+            for(int c = 0; c < 3; c++) {
+                push(next[r][c] = step(sub[r][c], sub_j));
+            }
+        }
+
+        for(int r = 0; r < 2; r++) {
+            for(int c = 0; c < 2; c++) {
+                struct hl_node_s *block = join(
+                    next[r][c], next[r][c + 1], next[r + 1][c],
+                    next[r + 1][c + 1]
+                );
+
+                push(block);
+                push(quadrant[r][c] = fast ? step(block, sub_j)
+                                           : center(block));
+            }
+        }
+
+        result = join(
+            quadrant[0][0], quadrant[0][1], quadrant[1][0], quadrant[1][1]
+        );
+    }
+
+    stack_size = base;
+    node->result = result;
+    node->result_step = j;
+
+    return result;
+}
+
+/*
+ * Surround the universe with dead cells, doubling its edge.
+ */
+static void expand(void) {
+    struct hl_node_s *e = empty_node(root->level - 1);
+    size_t base = stack_size;
+    struct hl_node_s *nw, *ne, *sw, *se;
+
+    push(nw = join(e, e, e, root->nw));
+    push(ne = join(e, e, root->ne, e));
+    push(sw = join(e, root->sw, e, e));
+    push(se = join(root->se, e, e, e));
+
+    root_x -= (int64_t)1 << (root->level - 1);
+    root_y -= (int64_t)1 << (root->level - 1);
+    root = join(nw, ne, sw, se);
+    stack_size = base;
+}
+
+/*
+ * Check whether every alive cell of the universe is in its center.
+ */
+static int centered(void) {
+    const struct hl_node_s *e = empty_node(root->level - 2);
+
+    return root->nw->nw == e && root->nw->ne == e && root->nw->sw == e &&
+           root->ne->nw == e && root->ne->ne == e && root->ne->se == e &&
+           root->sw->nw == e && root->sw->sw == e && root->sw->se == e &&
+           root->se->ne == e && root->se->sw == e && root->se->se == e;
+}
+
+/*
+ * Advance the universe by 2^j generations. The universe is expanded until
+ * its alive cells are far enough from the edge of the result, which is the
+ * new universe.
+ */
+static void advance(const int j) {
+    while(root->level < j + 2 || !centered()) {
+        expand();
+    }
+    expand();
+
+    root_x += (int64_t)1 << (root->level - 2);
+    root_y += (int64_t)1 << (root->level - 2);
+    root = step(root, j);
+}
+
+/*
+ * Build the node of level whose north-west cell is the cell x, y of the grid.
+ */
+static struct hl_node_s *build(
+    const game_of_life_t *const gol, const int64_t x, const int64_t y,
+    const int level
+) {
+    const int64_t cells = (*gol)->grid - 2;
+    const int64_t edge = (int64_t)1 << level;
+
+    if(x >= cells || y >= cells || x + edge <= 0 || y + edge <= 0) {
+        return empty_node(level);
+    }
+    if(level == 0) {
+        return &leaves[(*gol)->input_ptr[(*gol)->grid * (y + 1) + x + 1] != 0];
+    }
+
+    size_t base = stack_size;
+    const int64_t half = edge / 2;
+    struct hl_node_s *nw, *ne, *sw, *se;
+
+    push(nw = build(gol, x, y, level - 1));
+    push(ne = build(gol, x + half, y, level - 1));
+    push(sw = build(gol, x, y + half, level - 1));
+    push(se = build(gol, x + half, y + half, level - 1));
+
+    struct hl_node_s *node = join(nw, ne, sw, se);
+
+    stack_size = base;
+
+    return node;
+}
+
+/*
+ * Write the alive cells of a node of level whose north-west cell is the cell
+ * x, y of the grid. The cells outside of the grid are dropped.
+ */
+static void export(
+    const game_of_life_t *const gol, const struct hl_node_s *node,
+    const int64_t x, const int64_t y, const int level
+) {
+    const int64_t cells = (*gol)->grid - 2;
+    const int64_t edge = (int64_t)1 << level;
+
+    if(node == empty[level] || x >= cells || y >= cells || x + edge <= 0 ||
+       y + edge <= 0) {
+        return;
+    }
+    if(level == 0) {
+        (*gol)->input_ptr[(*gol)->grid * (y + 1) + x + 1] = node->alive;
+        return;
+    }
+
+    const int64_t half = edge / 2;
+
+    export(gol, node->nw, x, y, level - 1);
+    export(gol, node->ne, x + half, y, level - 1);
+    export(gol, node->sw, x, y + half, level - 1);
+    export(gol, node->se, x + half, y + half, level - 1);
+}
+
+/*
+ * Free every node and the memoized results.
+ */
+static void hashlife_destroy(void) {
+    for(size_t b = 0; b < bucket_count; b++) {
+        struct hl_node_s *node = buckets[b];
+
+        while(node != NULL) {
+            struct hl_node_s *next = node->next;
+
+            free(node);
+            node = next;
+        }
+    }
+    free(buckets);
+    free(stack);
+
+    buckets = NULL;
+    bucket_count = node_count = 0;
+    stack = NULL;
+    stack_size = stack_capacity = 0;
+    gc_threshold = HASHLIFE_MAX_NODES;
+    root = NULL;
+    for(int l = 0; l <= MAX_LEVEL; l++) {
+        empty[l] = NULL;
+    }
+}
+
+static void execute_hashlife(
+    const game_of_life_t *const gol, const int generations
+) {
+    int level = 2;
+
+    while(((int64_t)1 << level) < (*gol)->grid - 2) {
+        level++;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+    rehash();
+    root_x = root_y = 0;
+    root = build(gol, 0, 0, level);
+
+    for(int j = 0; (generations >> j) != 0; j++) {
+        if((generations >> j) & 1) {
+            advance(j);
+        }
+    }
+
+    for(int i = 1; i < (*gol)->grid - 1; i++) {
+        for(int j = 1; j < (*gol)->grid - 1; j++) {
+            (*gol)->input_ptr[(*gol)->grid * i + j] = 0;
+        }
+    }
+    export(gol, root, root_x, root_y, root->level);
+
+    hashlife_destroy();
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+/*
+ * The memoized recursion of HashLife is sequential, so the threads are not
+ * used.
+ */
+static void execute_parallel_hashlife(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    (void)threads;
+
+    execute_hashlife(gol, generations);
+}
+
+const struct gol_engine_s gol_hashlife_engine = {
+    .name = "hashlife",
+    .execute = execute_hashlife,
+    .execute_parallel = execute_parallel_hashlife,
+};
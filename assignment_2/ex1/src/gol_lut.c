@@ -0,0 +1,202 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gol_bitpacked.h"
+
+/* Neighborhoods of 4x4 cells */
+#define LUT_ENTRIES (1 << 16)
+
+/*
+ * The next generation of the 2x2 cells at the center of every 4x4
+ * neighborhood, two results per byte so that the table fits in the L1 cache.
+ *
+ * Bit 4 * r + c of a neighborhood is the cell of row r and column c. Bit
+ * 2 * r + c of a result is the cell of row r + 1 and column c + 1 of its
+ * neighborhood. The result of neighborhood n is in the low nibble of byte
+ * n / 2 if n is even, in the high nibble otherwise.
+ */
+static uint8_t lut[LUT_ENTRIES / 2];
+
+/* Set once the table is computed */
+static int lut_ready = 0;
+
+/*
+ * Compute the table. Called before any thread reads it.
+ */
+static void lut_compute(void) {
+    if(lut_ready) {
+        return;
+    }
+
+    for(int n = 0; n < LUT_ENTRIES; n++) {
+        int result = 0;
+
+        for(int r = 1; r <= 2; r++) {
+            for(int c = 1; c <= 2; c++) {
+                int neighbors = 0;
+
+                for(int dr = -1; dr <= 1; dr++) {
+                    for(int dc = -1; dc <= 1; dc++) {
+                        neighbors += (n >> (4 * (r + dr) + c + dc)) & 1;
+                    }
+                }
+
+                int alive = (n >> (4 * r + c)) & 1;
+
+                neighbors -= alive;
+                if(neighbors == 3 || (alive && neighbors == 2)) {
+                    result |= 1 << (2 * (r - 1) + (c - 1));
+                }
+            }
+        }
+
+        lut[n / 2] |= result << (4 * (n % 2));
+    }
+
+    lut_ready = 1;
+}
+
+/*
+ * Compute the next generation of the rows i and i + 1, 2x2 cells at a time.
+ *
+ * The four rows around a word of the two rows are read through windows of
+ * 66 bits, from the column before the word to the column after it. Every two
+ * columns, the low 4 bits of the windows make up a 4x4 neighborhood.
+ *
+ * Parameters:
+ * - packed: the packed grid, with one extra zero row below the grid, so that
+ * a pair of rows starting at the last one can be read.
+ * - i: the first row, odd and from 1 to the edge size of the grid.
+ */
+static void lut_rows(const struct bitpacked_s *const packed, const int i) {
+    const uint64_t *rows[4];
+    uint64_t *out0 = packed->output_ptr + packed->stride * i;
+    uint64_t *out1 = out0 + packed->stride;
+
+    for(int r = 0; r < 4; r++) {
+        rows[r] = packed->input_ptr + packed->stride * (i - 1 + r);
+    }
+
+    for(int k = 1; k <= packed->words; k++) {
+        unsigned __int128 window[4];
+        uint64_t next0 = 0;
+        uint64_t next1 = 0;
+
+        for(int r = 0; r < 4; r++) {
+            window[r] = (rows[r][k - 1] >> (WORD_BITS - 1)) |
+                        ((unsigned __int128)rows[r][k] << 1) |
+                        ((unsigned __int128)rows[r][k + 1] << (WORD_BITS + 1));
+        }
+
+        for(int c = 0; c < WORD_BITS; c += 2) {
+            unsigned int n = (window[0] & 0xf) | (window[1] & 0xf) << 4 |
+                             (window[2] & 0xf) << 8 | (window[3] & 0xf) << 12;
+            unsigned int result = (lut[n / 2] >> (4 * (n % 2))) & 0xf;
+
+            next0 |= (uint64_t)(result & 3) << c;
+            next1 |= (uint64_t)(result >> 2) << c;
+            for(int r = 0; r < 4; r++) {
+                window[r] >>= 2;
+            }
+        }
+
+        out0[k] = next0;
+        // The row after the last row of the grid is the south border
+        if(i < packed->cells) {
+            out1[k] = next1;
+        }
+    }
+
+    // The bits past the east edge are not cells of the grid
+    out0[packed->words] &= packed->last_mask;
+    if(i < packed->cells) {
+        out1[packed->words] &= packed->last_mask;
+    }
+}
+
+static void execute_lut(
+    const game_of_life_t *const gol, const int generations
+) {
+    struct bitpacked_s packed;
+    uint64_t *temp_ptr;
+
+    if(bitpacked_init(&packed, gol, 1) != 0) {
+        fprintf(stderr, "Error: unable to pack the grid, using naive.\n");
+        gol_naive_engine.execute(gol, generations);
+        return;
+    }
+    lut_compute();
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+    for(int gen = 0; gen < generations; gen++) {
+        for(int i = 1; i <= packed.cells; i += 2) {
+            lut_rows(&packed, i);
+        }
+
+        temp_ptr = packed.input_ptr;
+        packed.input_ptr = packed.output_ptr;
+        packed.output_ptr = temp_ptr;
+    }
+
+    bitpacked_destroy(&packed, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+static void execute_parallel_lut(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    struct bitpacked_s packed;
+    uint64_t *temp_ptr;
+
+    if(bitpacked_init(&packed, gol, 1) != 0) {
+        fprintf(stderr, "Error: unable to pack the grid, using naive.\n");
+        gol_naive_engine.execute_parallel(gol, generations, threads);
+        return;
+    }
+    lut_compute();
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+#pragma omp parallel num_threads(threads) default(none)                        \
+    shared(packed, generations, temp_ptr)
+    {
+        for(int gen = 0; gen < generations; gen++) {
+#pragma omp for schedule(static)
+            for(int i = 1; i <= packed.cells; i += 2) {
+                lut_rows(&packed, i);
+            }
+
+#pragma omp single
+            {
+                temp_ptr = packed.input_ptr;
+                packed.input_ptr = packed.output_ptr;
+                packed.output_ptr = temp_ptr;
+            }
+        }
+    }
+
+    bitpacked_destroy(&packed, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+const struct gol_engine_s gol_lut_engine = {
+    .name = "lut",
+    .execute = execute_lut,
+    .execute_parallel = execute_parallel_lut,
+};
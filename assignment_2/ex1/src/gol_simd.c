@@ -0,0 +1,326 @@
+#include <immintrin.h>
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gol_engine.h"
+
+/* Alignment of the rows, the width of the widest vector */
+#define ROW_ALIGN 64
+
+/*
+ * The cells of a generation, one byte per cell. The rows are laid out as the
+ * rows of the dense grid, west border included, but start at a multiple of
+ * ROW_ALIGN and are padded with at least ROW_ALIGN dead cells, so that a
+ * kernel reads and writes whole vectors past the east border. A dead row
+ * lies before the north border as well, for the west neighbors of column 0.
+ */
+struct simd_s {
+    uint8_t *memory;
+    uint8_t *input_ptr;
+    uint8_t *output_ptr;
+    /* The edge size of the grid, without the borders */
+    int cells;
+    /* The bytes of a row */
+    int stride;
+};
+
+/*
+ * Compute the next generation of the columns 0 to columns - 1 of a row. The
+ * columns are rounded up to the width of the vectors of the kernel.
+ */
+typedef void (*simd_kernel_t)(
+    const uint8_t *above, const uint8_t *row, const uint8_t *below,
+    uint8_t *out, int columns
+);
+
+/*
+ * Count the neighbors of every cell, first summing each column of three
+ * cells and then three adjacent column sums. The sum includes the cell
+ * itself, so the cell is alive in the next generation if the sum is 3, or if
+ * it is 4 and the cell is alive.
+ */
+static void kernel_generic(
+    const uint8_t *above, const uint8_t *row, const uint8_t *below,
+    uint8_t *out, int columns
+) {
+    for(int j = 0; j < columns; j++) {
+        uint8_t sum = above[j - 1] + row[j - 1] + below[j - 1] + above[j] +
+                      row[j] + below[j] + above[j + 1] + row[j + 1] +
+                      below[j + 1];
+
+        out[j] = (sum == 3) | ((sum == 4) & row[j]);
+    }
+}
+
+__attribute__((target("avx2"))) static void kernel_avx2(
+    const uint8_t *above, const uint8_t *row, const uint8_t *below,
+    uint8_t *out, int columns
+) {
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i one = _mm256_set1_epi8(1);
+
+    for(int j = 0; j < columns; j += 32) {
+        // Sums of the columns j - 1, j and j + 1
+        __m256i west = _mm256_add_epi8(
+            _mm256_add_epi8(
+                _mm256_loadu_si256((const __m256i *)(above + j - 1)),
+                _mm256_loadu_si256((const __m256i *)(row + j - 1))
+            ),
+            _mm256_loadu_si256((const __m256i *)(below + j - 1))
+        );
+        __m256i cell = _mm256_load_si256((const __m256i *)(row + j));
+        __m256i center = _mm256_add_epi8(
+            _mm256_add_epi8(
+                _mm256_load_si256((const __m256i *)(above + j)), cell
+            ),
+            _mm256_load_si256((const __m256i *)(below + j))
+        );
+        __m256i east = _mm256_add_epi8(
+            _mm256_add_epi8(
+                _mm256_loadu_si256((const __m256i *)(above + j + 1)),
+                _mm256_loadu_si256((const __m256i *)(row + j + 1))
+            ),
+            _mm256_loadu_si256((const __m256i *)(below + j + 1))
+        );
+        __m256i sum = _mm256_add_epi8(_mm256_add_epi8(west, center), east);
+
+        __m256i alive = _mm256_or_si256(
+            _mm256_cmpeq_epi8(sum, three),
+            _mm256_and_si256(
+                _mm256_cmpeq_epi8(sum, four), _mm256_cmpeq_epi8(cell, one)
+            )
+        );
+        _mm256_store_si256((__m256i *)(out + j), _mm256_and_si256(alive, one));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw"))) static void kernel_avx512(
+    const uint8_t *above, const uint8_t *row, const uint8_t *below,
+    uint8_t *out, int columns
+) {
+    const __m512i three = _mm512_set1_epi8(3);
+    const __m512i four = _mm512_set1_epi8(4);
+    const __m512i one = _mm512_set1_epi8(1);
+
+    for(int j = 0; j < columns; j += 64) {
+        // Sums of the columns j - 1, j and j + 1
+        __m512i west = _mm512_add_epi8(
+            _mm512_add_epi8(
+                _mm512_loadu_si512(above + j - 1),
+                _mm512_loadu_si512(row + j - 1)
+            ),
+            _mm512_loadu_si512(below + j - 1)
+        );
+        __m512i cell = _mm512_load_si512(row + j);
+        __m512i center = _mm512_add_epi8(
+            _mm512_add_epi8(_mm512_load_si512(above + j), cell),
+            _mm512_load_si512(below + j)
+        );
+        __m512i east = _mm512_add_epi8(
+            _mm512_add_epi8(
+                _mm512_loadu_si512(above + j + 1),
+                _mm512_loadu_si512(row + j + 1)
+            ),
+            _mm512_loadu_si512(below + j + 1)
+        );
+        __m512i sum = _mm512_add_epi8(_mm512_add_epi8(west, center), east);
+
+        __mmask64 alive = _mm512_cmpeq_epi8_mask(sum, three) |
+                          (_mm512_cmpeq_epi8_mask(sum, four) &
+                           _mm512_test_epi8_mask(cell, cell));
+        _mm512_store_si512(out + j, _mm512_maskz_mov_epi8(alive, one));
+    }
+}
+
+/*
+ * Select the widest kernel the processor supports.
+ *
+ * Returns:
+ * - the kernel.
+ */
+static simd_kernel_t simd_kernel(void) {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512bw")) {
+        return kernel_avx512;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        return kernel_avx2;
+    }
+
+    return kernel_generic;
+}
+
+/*
+ * Copy the dense grid of the game of life object into bytes.
+ *
+ * Parameters:
+ * - grid: the byte grid.
+ * - gol: the game of life object.
+ *
+ * Returns:
+ * - 0 if the function executed successfully.
+ * - 1 if there an error occurred.
+ */
+static int simd_init(
+    struct simd_s *const grid, const game_of_life_t *const gol
+) {
+    grid->cells = (*gol)->grid - 2;
+    grid->stride = (grid->cells + 1 + 2 * ROW_ALIGN) / ROW_ALIGN * ROW_ALIGN;
+
+    // The dead row before the north border, then two grids
+    size_t size = (size_t)(1 + 2 * (grid->cells + 2)) * grid->stride;
+
+    if((grid->memory = aligned_alloc(ROW_ALIGN, size)) == NULL) {
+        return 1;
+    }
+    memset(grid->memory, 0, size);
+    grid->input_ptr = grid->memory + grid->stride;
+    grid->output_ptr =
+        grid->input_ptr + (size_t)(grid->cells + 2) * grid->stride;
+
+    for(int i = 1; i <= grid->cells; i++) {
+        const int *row = (*gol)->input_ptr + (*gol)->grid * i;
+        uint8_t *bytes = grid->input_ptr + (size_t)grid->stride * i;
+
+        for(int j = 1; j <= grid->cells; j++) {
+            bytes[j] = row[j] != 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Copy the bytes into the dense grid of the game of life object and free the
+ * byte grid.
+ *
+ * Parameters:
+ * - grid: the byte grid.
+ * - gol: the game of life object.
+ */
+static void simd_destroy(
+    struct simd_s *const grid, const game_of_life_t *const gol
+) {
+    for(int i = 1; i <= grid->cells; i++) {
+        int *row = (*gol)->input_ptr + (*gol)->grid * i;
+        const uint8_t *bytes = grid->input_ptr + (size_t)grid->stride * i;
+
+        for(int j = 1; j <= grid->cells; j++) {
+            row[j] = bytes[j];
+        }
+    }
+
+    free(grid->memory);
+}
+
+/*
+ * Compute the next generation of a row, then kill the border and padding
+ * cells the kernel wrote.
+ *
+ * Parameters:
+ * - grid: the byte grid.
+ * - kernel: the kernel.
+ * - i: the row, from 1 to the edge size of the grid.
+ */
+static void simd_row(
+    const struct simd_s *const grid, const simd_kernel_t kernel, const int i
+) {
+    const uint8_t *row = grid->input_ptr + (size_t)grid->stride * i;
+    uint8_t *out = grid->output_ptr + (size_t)grid->stride * i;
+    int columns = (grid->cells + ROW_ALIGN) / ROW_ALIGN * ROW_ALIGN;
+
+    kernel(row - grid->stride, row, row + grid->stride, out, columns);
+
+    out[0] = 0;
+    memset(out + grid->cells + 1, 0, columns - grid->cells - 1);
+}
+
+static void execute_simd(
+    const game_of_life_t *const gol, const int generations
+) {
+    struct simd_s grid;
+    simd_kernel_t kernel = simd_kernel();
+    uint8_t *temp_ptr;
+
+    if(simd_init(&grid, gol) != 0) {
+        fprintf(stderr, "Error: unable to copy the grid, using naive.\n");
+        gol_naive_engine.execute(gol, generations);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+    for(int gen = 0; gen < generations; gen++) {
+        for(int i = 1; i <= grid.cells; i++) {
+            simd_row(&grid, kernel, i);
+        }
+
+        temp_ptr = grid.input_ptr;
+        grid.input_ptr = grid.output_ptr;
+        grid.output_ptr = temp_ptr;
+    }
+
+    simd_destroy(&grid, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+static void execute_parallel_simd(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    struct simd_s grid;
+    simd_kernel_t kernel = simd_kernel();
+    uint8_t *temp_ptr;
+
+    if(simd_init(&grid, gol) != 0) {
+        fprintf(stderr, "Error: unable to copy the grid, using naive.\n");
+        gol_naive_engine.execute_parallel(gol, generations, threads);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+#pragma omp parallel num_threads(threads) default(none)                        \
+    shared(grid, kernel, generations, temp_ptr)
+    {
+        for(int gen = 0; gen < generations; gen++) {
+#pragma omp for schedule(static)
+            for(int i = 1; i <= grid.cells; i++) {
+                simd_row(&grid, kernel, i);
+            }
+
+#pragma omp single
+            {
+                temp_ptr = grid.input_ptr;
+                grid.input_ptr = grid.output_ptr;
+                grid.output_ptr = temp_ptr;
+            }
+        }
+    }
+
+    simd_destroy(&grid, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+const struct gol_engine_s gol_simd_engine = {
+    .name = "simd",
+    .execute = execute_simd,
+    .execute_parallel = execute_parallel_simd,
+};
@@ -0,0 +1,338 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gol_bitpacked.h"
+
+/* Words of the cells of a tile, without the halo */
+#define TILE_WORDS 16
+
+/* Generations advanced at most in a tile, within the halo word */
+#define MAX_HALO 32
+
+/* Tiles a thread gets at least, so that the threads stay balanced */
+#define TILES_PER_THREAD 4
+
+/* Cache size used when the system does not report the size of the L2 */
+#define DEFAULT_CACHE_SIZE (1 << 20)
+
+/*
+ * The packed grid divided into tiles that are advanced halo generations at a
+ * time.
+ *
+ * A tile is copied into a local grid together with a halo of halo rows above
+ * and below it and one word (64 columns) on each side. The local grid is
+ * advanced halo generations, each one a row shorter on both ends than the
+ * previous one, since the cells next to the end of the local grid are wrong.
+ * The wrong cells move one cell per generation, so they do not reach the
+ * tile before halo generations, and the tile is written back to the grid.
+ * The grid is read and written once every halo generations instead of once
+ * every generation, and the local grids of a thread stay in its cache.
+ */
+struct temporal_s {
+    struct bitpacked_s packed;
+    /* The rows and words of the cells of a tile */
+    int tile_rows;
+    int tile_words;
+    /* The tiles in a column and in a row of tiles */
+    int rows;
+    int columns;
+    int halo;
+    /* The layout of the local grids, as the packed grid */
+    int local_rows;
+    int local_words;
+    int local_stride;
+    /* The two local grids of every thread */
+    uint64_t *local_ptr;
+    size_t local_size;
+};
+
+/*
+ * Size the tiles and the halo, so that the two local grids of a thread take
+ * half of the L2 cache and the halo is an eighth of the local rows. With more
+ * than one thread, the tiles are made shorter until every thread gets at
+ * least TILES_PER_THREAD of them, and the rows are split evenly among the
+ * tiles of a column.
+ *
+ * Parameters:
+ * - temporal: the tiles, with the packed grid.
+ * - threads: the number of threads.
+ */
+static void temporal_plan(
+    struct temporal_s *const temporal, const int threads
+) {
+    const struct bitpacked_s *packed = &temporal->packed;
+    long cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
+
+    if(cache <= 0) {
+        cache = DEFAULT_CACHE_SIZE;
+    }
+
+    temporal->tile_words =
+        packed->words < TILE_WORDS ? packed->words : TILE_WORDS;
+    temporal->local_words = temporal->tile_words + 2;
+    temporal->local_stride = temporal->local_words + 2;
+    temporal->columns =
+        (packed->words + temporal->tile_words - 1) / temporal->tile_words;
+
+    long local_rows =
+        cache / 2 / (2 * temporal->local_stride * (long)sizeof(uint64_t));
+
+    temporal->halo = local_rows / 8;
+    if(temporal->halo > MAX_HALO) {
+        temporal->halo = MAX_HALO;
+    } else if(temporal->halo < 1) {
+        temporal->halo = 1;
+    }
+
+    long tile_rows = local_rows - 2 * temporal->halo;
+    if(tile_rows < 1) {
+        tile_rows = 1;
+    }
+
+    temporal->rows = (packed->cells + tile_rows - 1) / tile_rows;
+    if(threads > 1 &&
+       (long)temporal->rows * temporal->columns < TILES_PER_THREAD * threads) {
+        temporal->rows =
+            (TILES_PER_THREAD * threads + temporal->columns - 1) /
+            temporal->columns;
+    }
+    if(temporal->rows > packed->cells) {
+        temporal->rows = packed->cells;
+    }
+
+    // Split the rows evenly, only the last tile of a column may be shorter
+    temporal->tile_rows =
+        (packed->cells + temporal->rows - 1) / temporal->rows;
+    temporal->rows =
+        (packed->cells + temporal->tile_rows - 1) / temporal->tile_rows;
+
+    // A halo taller than the tile would mostly compute cells thrown away
+    if(temporal->halo > temporal->tile_rows) {
+        temporal->halo = temporal->tile_rows;
+    }
+    temporal->local_rows = temporal->tile_rows + 2 * temporal->halo;
+}
+
+/*
+ * Pack the dense grid and allocate the local grids.
+ *
+ * Parameters:
+ * - temporal: the tiles.
+ * - gol: the game of life object.
+ * - threads: the number of threads.
+ *
+ * Returns:
+ * - 0 if the function executed successfully.
+ * - 1 if there an error occurred.
+ */
+static int temporal_init(
+    struct temporal_s *const temporal, const game_of_life_t *const gol,
+    const int threads
+) {
+    if(bitpacked_init(&temporal->packed, gol, 0) != 0) {
+        return 1;
+    }
+    temporal_plan(temporal, threads);
+
+    // The zero rows above and below the local grid are never written
+    temporal->local_size =
+        (size_t)(temporal->local_rows + 2) * temporal->local_stride;
+    temporal->local_ptr =
+        calloc(2 * threads * temporal->local_size, sizeof(uint64_t));
+    if(temporal->local_ptr == NULL) {
+        bitpacked_destroy(&temporal->packed, gol);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Advance a tile and write it to the output grid.
+ *
+ * Parameters:
+ * - temporal: the tiles.
+ * - local_ptr: the two local grids of the calling thread.
+ * - t: the index of the tile.
+ * - generations: the generations, from 1 to the halo.
+ */
+static void temporal_tile(
+    const struct temporal_s *const temporal, uint64_t *const local_ptr,
+    const int t, const int generations
+) {
+    const struct bitpacked_s *packed = &temporal->packed;
+    // The local row 1 and the local word 1 are the first of the halo
+    const int row = t / temporal->columns * temporal->tile_rows + 1;
+    const int first_row = row - temporal->halo - 1;
+    const int first_word = t % temporal->columns * temporal->tile_words - 1;
+    struct bitpacked_s local = {
+        .input_ptr = local_ptr,
+        .output_ptr = local_ptr + temporal->local_size,
+        .cells = 0,
+        .words = temporal->local_words,
+        .stride = temporal->local_stride,
+        .last_mask = ~UINT64_C(0),
+    };
+    uint64_t masks[TILE_WORDS + 3];
+
+    // Keep the cells outside of the grid dead in every generation
+    for(int k = 1; k <= temporal->local_words; k++) {
+        int word = first_word + k;
+
+        masks[k] = word < 1 || word > packed->words ? 0
+                   : word == packed->words          ? packed->last_mask
+                                                    : ~UINT64_C(0);
+    }
+
+    for(int i = 1; i <= temporal->local_rows; i++) {
+        int global_row = first_row + i;
+
+        for(int k = 1; k <= temporal->local_words; k++) {
+            local.input_ptr[local.stride * i + k] =
+                masks[k] != 0 && global_row >= 1 &&
+                        global_row <= packed->cells
+                    ? packed->input_ptr[packed->stride * global_row +
+                                        first_word + k]
+                    : 0;
+        }
+    }
+
+    for(int gen = 0; gen < generations; gen++) {
+        for(int i = 1 + gen; i <= temporal->local_rows - gen; i++) {
+            int global_row = first_row + i;
+            uint64_t *out = local.output_ptr + local.stride * i;
+
+            if(global_row < 1 || global_row > packed->cells) {
+                memset(out + 1, 0, local.words * sizeof(uint64_t));
+                continue;
+            }
+            for(int k = 1; k <= local.words; k++) {
+                out[k] = bitpacked_word(&local, i, k) & masks[k];
+            }
+        }
+
+        uint64_t *temp_ptr = local.input_ptr;
+
+        local.input_ptr = local.output_ptr;
+        local.output_ptr = temp_ptr;
+    }
+
+    for(int i = temporal->halo + 1;
+        i <= temporal->halo + temporal->tile_rows &&
+        first_row + i <= packed->cells;
+        i++) {
+        for(int k = 2; k <= temporal->tile_words + 1 &&
+                       first_word + k <= packed->words;
+            k++) {
+            packed->output_ptr[packed->stride * (first_row + i) + first_word +
+                               k] = local.input_ptr[local.stride * i + k];
+        }
+    }
+}
+
+/*
+ * Swap the input and the output grid.
+ *
+ * Parameters:
+ * - temporal: the tiles.
+ */
+static void temporal_swap(struct temporal_s *const temporal) {
+    uint64_t *temp_ptr = temporal->packed.input_ptr;
+
+    temporal->packed.input_ptr = temporal->packed.output_ptr;
+    temporal->packed.output_ptr = temp_ptr;
+}
+
+static void execute_temporal(
+    const game_of_life_t *const gol, const int generations
+) {
+    struct temporal_s temporal;
+
+    if(temporal_init(&temporal, gol, 1) != 0) {
+        fprintf(stderr, "Error: unable to tile the grid, using naive.\n");
+        gol_naive_engine.execute(gol, generations);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Tiles of %d x %d words, halo of %d rows\n", temporal.tile_rows,
+           temporal.tile_words, temporal.halo);
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+    for(int gen = 0; gen < generations; gen += temporal.halo) {
+        int steps = generations - gen < temporal.halo ? generations - gen
+                                                      : temporal.halo;
+
+        for(int t = 0; t < temporal.rows * temporal.columns; t++) {
+            temporal_tile(&temporal, temporal.local_ptr, t, steps);
+        }
+        temporal_swap(&temporal);
+    }
+
+    free(temporal.local_ptr);
+    bitpacked_destroy(&temporal.packed, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+static void execute_parallel_temporal(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    struct temporal_s temporal;
+
+    if(temporal_init(&temporal, gol, threads) != 0) {
+        fprintf(stderr, "Error: unable to tile the grid, using naive.\n");
+        gol_naive_engine.execute_parallel(gol, generations, threads);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Tiles of %d x %d words, halo of %d rows\n", temporal.tile_rows,
+           temporal.tile_words, temporal.halo);
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+#pragma omp parallel num_threads(threads) default(none)                        \
+    shared(temporal, generations)
+    {
+        uint64_t *local_ptr = temporal.local_ptr + 2 * omp_get_thread_num() *
+                                                       temporal.local_size;
+
+        for(int gen = 0; gen < generations; gen += temporal.halo) {
+            int steps = generations - gen < temporal.halo ? generations - gen
+                                                          : temporal.halo;
+
+#pragma omp for schedule(static)
+            for(int t = 0; t < temporal.rows * temporal.columns; t++) {
+                temporal_tile(&temporal, local_ptr, t, steps);
+            }
+
+#pragma omp single
+            temporal_swap(&temporal);
+        }
+    }
+
+    free(temporal.local_ptr);
+    bitpacked_destroy(&temporal.packed, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+const struct gol_engine_s gol_temporal_engine = {
+    .name = "temporal",
+    .execute = execute_temporal,
+    .execute_parallel = execute_parallel_temporal,
+};
@@ -0,0 +1,259 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gol_bitpacked.h"
+
+/* Rows of a tile, a tile is one word wide */
+#define TILE_ROWS 64
+
+/*
+ * The packed grid divided into tiles of TILE_ROWS x WORD_BITS cells.
+ *
+ * A tile is active in a generation if it or one of its eight neighbors
+ * changed in the previous generation, and only the active tiles are
+ * computed. An inactive tile is the same in both buffers, since it did not
+ * change since the buffer that receives the next generation was written, so
+ * it is not even copied.
+ */
+struct tiles_s {
+    struct bitpacked_s packed;
+    /* The tiles in a column and in a row of tiles */
+    int rows;
+    int columns;
+    /* Whether every tile changed in the previous generation */
+    unsigned char *changed;
+    /* Whether every tile changes in the current generation */
+    unsigned char *changed_next;
+    /* The indices of the active tiles, and their number */
+    int *active;
+    int active_count;
+};
+
+/*
+ * Pack the dense grid and mark every tile as changed.
+ *
+ * Parameters:
+ * - tiles: the tiles.
+ * - gol: the game of life object.
+ *
+ * Returns:
+ * - 0 if the function executed successfully.
+ * - 1 if there an error occurred.
+ */
+static int tiles_init(
+    struct tiles_s *const tiles, const game_of_life_t *const gol
+) {
+    if(bitpacked_init(&tiles->packed, gol, 0) != 0) {
+        return 1;
+    }
+
+    tiles->rows = (tiles->packed.cells + TILE_ROWS - 1) / TILE_ROWS;
+    tiles->columns = tiles->packed.words;
+
+    size_t count = (size_t)tiles->rows * tiles->columns;
+
+    tiles->changed = malloc(count);
+    tiles->changed_next = malloc(count);
+    tiles->active = malloc(count * sizeof(int));
+    if(tiles->changed == NULL || tiles->changed_next == NULL ||
+       tiles->active == NULL) {
+        free(tiles->changed);
+        free(tiles->changed_next);
+        free(tiles->active);
+        bitpacked_destroy(&tiles->packed, gol);
+
+        return 1;
+    }
+
+    for(size_t t = 0; t < count; t++) {
+        tiles->changed[t] = 1;
+    }
+    tiles->active_count = 0;
+
+    return 0;
+}
+
+/*
+ * Unpack the grid and free the tiles.
+ *
+ * Parameters:
+ * - tiles: the tiles.
+ * - gol: the game of life object.
+ */
+static void tiles_destroy(
+    struct tiles_s *const tiles, const game_of_life_t *const gol
+) {
+    free(tiles->changed);
+    free(tiles->changed_next);
+    free(tiles->active);
+    bitpacked_destroy(&tiles->packed, gol);
+}
+
+/*
+ * List the active tiles of the current generation and clear the changes of
+ * the tiles.
+ *
+ * Parameters:
+ * - tiles: the tiles.
+ */
+static void tiles_collect(struct tiles_s *const tiles) {
+    tiles->active_count = 0;
+
+    for(int r = 0; r < tiles->rows; r++) {
+        for(int c = 0; c < tiles->columns; c++) {
+            int active = 0;
+
+            for(int dr = -1; dr <= 1 && !active; dr++) {
+                for(int dc = -1; dc <= 1 && !active; dc++) {
+                    int nr = r + dr;
+                    int nc = c + dc;
+
+                    active = nr >= 0 && nr < tiles->rows && nc >= 0 &&
+                             nc < tiles->columns &&
+                             tiles->changed[nr * tiles->columns + nc];
+                }
+            }
+
+            if(active) {
+                tiles->active[tiles->active_count++] = r * tiles->columns + c;
+            }
+            tiles->changed_next[r * tiles->columns + c] = 0;
+        }
+    }
+}
+
+/*
+ * Compute the next generation of a tile and record whether it changed.
+ *
+ * Parameters:
+ * - tiles: the tiles.
+ * - t: the index of the tile.
+ */
+static void tiles_step(const struct tiles_s *const tiles, const int t) {
+    const struct bitpacked_s *packed = &tiles->packed;
+    int k = t % tiles->columns + 1;
+    int first = t / tiles->columns * TILE_ROWS + 1;
+    int last = first + TILE_ROWS - 1;
+    uint64_t diff = 0;
+
+    if(last > packed->cells) {
+        last = packed->cells;
+    }
+
+    for(int i = first; i <= last; i++) {
+        uint64_t next = bitpacked_word(packed, i, k);
+
+        diff |= next ^ packed->input_ptr[packed->stride * i + k];
+        packed->output_ptr[packed->stride * i + k] = next;
+    }
+
+    tiles->changed_next[t] = diff != 0;
+}
+
+/*
+ * Swap the buffers and the changes of the tiles.
+ *
+ * Parameters:
+ * - tiles: the tiles.
+ */
+static void tiles_swap(struct tiles_s *const tiles) {
+    uint64_t *temp_ptr = tiles->packed.input_ptr;
+    unsigned char *temp_changed = tiles->changed;
+
+    tiles->packed.input_ptr = tiles->packed.output_ptr;
+    tiles->packed.output_ptr = temp_ptr;
+    tiles->changed = tiles->changed_next;
+    tiles->changed_next = temp_changed;
+}
+
+static void execute_tiles(
+    const game_of_life_t *const gol, const int generations
+) {
+    struct tiles_s tiles;
+
+    if(tiles_init(&tiles, gol) != 0) {
+        fprintf(stderr, "Error: unable to tile the grid, using naive.\n");
+        gol_naive_engine.execute(gol, generations);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+    for(int gen = 0; gen < generations; gen++) {
+        tiles_collect(&tiles);
+        for(int a = 0; a < tiles.active_count; a++) {
+            tiles_step(&tiles, tiles.active[a]);
+        }
+        tiles_swap(&tiles);
+    }
+
+#ifdef DEBUG
+    printf("Active tiles in the last generation: %d of %d\n",
+           tiles.active_count, tiles.rows * tiles.columns);
+#endif
+
+    tiles_destroy(&tiles, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+static void execute_parallel_tiles(
+    const game_of_life_t *const gol, const int generations, const int threads
+) {
+    struct tiles_s tiles;
+
+    if(tiles_init(&tiles, gol) != 0) {
+        fprintf(stderr, "Error: unable to tile the grid, using naive.\n");
+        gol_naive_engine.execute_parallel(gol, generations, threads);
+        return;
+    }
+
+#ifdef DEBUG
+    printf("Initial state:\n");
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+
+#pragma omp parallel num_threads(threads) default(none)                        \
+    shared(tiles, generations)
+    {
+        for(int gen = 0; gen < generations; gen++) {
+#pragma omp single
+            tiles_collect(&tiles);
+
+            // The active tiles are scattered, so they are handed out in
+            // small chunks rather than in one block per thread
+#pragma omp for schedule(dynamic, 4)
+            for(int a = 0; a < tiles.active_count; a++) {
+                tiles_step(&tiles, tiles.active[a]);
+            }
+
+#pragma omp single
+            tiles_swap(&tiles);
+        }
+    }
+
+#ifdef DEBUG
+    printf("Active tiles in the last generation: %d of %d\n",
+           tiles.active_count, tiles.rows * tiles.columns);
+#endif
+
+    tiles_destroy(&tiles, gol);
+
+#ifdef DEBUG
+    printf("After generation %d:\n", generations - 1);
+    print_cells((*gol)->input_ptr, (*gol)->grid);
+#endif
+}
+
+const struct gol_engine_s gol_tiles_engine = {
+    .name = "tiles",
+    .execute = execute_tiles,
+    .execute_parallel = execute_parallel_tiles,
+};
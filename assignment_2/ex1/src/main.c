@@ -6,17 +6,25 @@
 #include "timer.h"
 
 void argument_parse_error_message(char *program_name) {
-    printf("Usage: %s <generations> <grid> <mode> <threads>\n", program_name);
+    printf(
+        "Usage: %s <generations> <grid> <mode> <threads> [engine]\n",
+        program_name
+    );
     printf("\nArguments:\n");
     printf(" - generations: the number of generations to simulate.\n");
     printf(" - grid: the size of the grid (e.g. 10 for 10x10 grid).\n");
     printf(" - mode: (0) serial or (1) parallel.\n");
     printf(" - threads: the number of threads in parallel mode.\n");
+    printf(" - engine: one of");
+    for(int i = 0; i < gol_engine_count(); i++) {
+        printf(" %s", gol_engine_name(i));
+    }
+    printf(" (default %s).\n", gol_engine_name(0));
 }
 
 int main(int argc, char *argv[]) {
     // Parse arguments
-    if(argc != 5) {
+    if(argc != 5 && argc != 6) {
         argument_parse_error_message(argv[0]);
         return 1;
     }
@@ -32,6 +40,12 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Error: unable to initialize the game of life.\n");
         return 1;
     }
+    if(argc == 6 && gol_set_engine(&gol, argv[5]) != 0) {
+        fprintf(stderr, "Error: unknown engine %s.\n", argv[5]);
+        argument_parse_error_message(argv[0]);
+        gol_destroy(&gol);
+        return 1;
+    }
 
 // Fill the input matrix
 #ifdef DEBUG